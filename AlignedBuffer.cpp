@@ -0,0 +1,103 @@
+#include "AlignedBuffer.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <sys/mman.h>
+
+namespace {
+
+inline size_t AlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}
+
+AlignedBuffer::AlignedBuffer()
+    : m_Data(nullptr), m_Size(0), m_MappedSize(0)
+{
+}
+
+AlignedBuffer::AlignedBuffer(size_t size)
+    : m_Data(nullptr), m_Size(0), m_MappedSize(0)
+{
+    if (size == 0)
+        return;
+
+    if (size >= s_HugePageThreshold)
+    {
+        // over-map by one huge page and trim both ends to a 2 MiB boundary
+        size_t length = AlignUp(size, s_HugePageSize);
+        size_t reserved = length + s_HugePageSize;
+        void* mapping = mmap(nullptr, reserved, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping != MAP_FAILED)
+        {
+            uintptr_t start = reinterpret_cast<uintptr_t>(mapping);
+            uintptr_t aligned = AlignUp(start, s_HugePageSize);
+            if (aligned > start)
+                munmap(mapping, aligned - start);
+            size_t tail = reserved - (aligned - start) - length;
+            if (tail)
+                munmap(reinterpret_cast<void*>(aligned + length), tail);
+#ifdef MADV_HUGEPAGE
+            madvise(reinterpret_cast<void*>(aligned), length, MADV_HUGEPAGE);
+#endif
+            // anonymous mappings are already zero
+            m_Data = reinterpret_cast<void*>(aligned);
+            m_Size = size;
+            m_MappedSize = length;
+            return;
+        }
+    }
+
+    m_Data = std::aligned_alloc(s_CacheLine, AlignUp(size, s_CacheLine));
+    if (!m_Data)
+    {
+        std::cout << "Failed to allocate " << size << " bytes" << std::endl;
+        return;
+    }
+    std::memset(m_Data, 0, size);
+    m_Size = size;
+}
+
+AlignedBuffer::~AlignedBuffer()
+{
+    Release();
+}
+
+AlignedBuffer::AlignedBuffer(AlignedBuffer&& other) noexcept
+    : m_Data(other.m_Data), m_Size(other.m_Size), m_MappedSize(other.m_MappedSize)
+{
+    other.m_Data = nullptr;
+    other.m_Size = 0;
+    other.m_MappedSize = 0;
+}
+
+AlignedBuffer& AlignedBuffer::operator=(AlignedBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        m_Data = other.m_Data;
+        m_Size = other.m_Size;
+        m_MappedSize = other.m_MappedSize;
+        other.m_Data = nullptr;
+        other.m_Size = 0;
+        other.m_MappedSize = 0;
+    }
+    return *this;
+}
+
+void AlignedBuffer::Release()
+{
+    if (m_MappedSize)
+        munmap(m_Data, m_MappedSize);
+    else
+        std::free(m_Data);
+    m_Data = nullptr;
+    m_Size = 0;
+    m_MappedSize = 0;
+}
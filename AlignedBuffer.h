@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+
+// Zero-filled block of memory aligned to a cache line. Blocks of at least
+// s_HugePageThreshold bytes are mapped anonymously on a 2 MiB boundary and
+// marked MADV_HUGEPAGE so that transparent huge pages can back them, which
+// keeps TLB misses down when a whole board is swept; smaller blocks come
+// from aligned_alloc.
+class AlignedBuffer
+{
+private:
+    void* m_Data;
+    size_t m_Size;
+    size_t m_MappedSize;    // length of the mapping, 0 when heap allocated
+public:
+    static const size_t s_CacheLine = 64;
+    static const size_t s_HugePageSize = 2 * 1024 * 1024;
+    static const size_t s_HugePageThreshold = 4 * 1024 * 1024;
+
+    AlignedBuffer();
+    explicit AlignedBuffer(size_t size);
+    ~AlignedBuffer();
+
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+    AlignedBuffer(AlignedBuffer&& other) noexcept;
+    AlignedBuffer& operator=(AlignedBuffer&& other) noexcept;
+
+    void Release();
+
+    inline unsigned char* GetData() { return static_cast<unsigned char*>(m_Data); }
+    inline const unsigned char* GetData() const { return static_cast<const unsigned char*>(m_Data); }
+    inline size_t GetSize() const { return m_Size; }
+    inline bool IsHugePageCandidate() const { return m_MappedSize != 0; }
+};
@@ -0,0 +1,153 @@
+#include "AssetArchive.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+
+const char AssetArchive::s_Magic[8] = { 'A', 'S', 'S', 'E', 'T', 'P', 'A', 'K' };
+
+AssetArchive::AssetArchive()
+    : m_Entries(nullptr), m_EntryCount(0), m_Names(nullptr), m_NamesSize(0)
+{
+}
+
+AssetArchive::AssetArchive(const std::string &path)
+    : m_File(path), m_Entries(nullptr), m_EntryCount(0), m_Names(nullptr), m_NamesSize(0)
+{
+    if (!m_File.IsOpen() || m_File.GetSize() < sizeof(AssetArchiveHeader))
+        return;
+
+    const AssetArchiveHeader* header = reinterpret_cast<const AssetArchiveHeader*>(m_File.GetData());
+    // sizes are compared against what is left, so no sum can wrap around
+    const uint64_t fileSize = m_File.GetSize();
+    uint64_t indexEnd = sizeof(AssetArchiveHeader) + (uint64_t)header->EntryCount * sizeof(AssetArchiveEntry);
+    if (std::memcmp(header->Magic, s_Magic, sizeof(s_Magic)) != 0 || header->Version != s_Version
+        || indexEnd > fileSize
+        || header->NameTableOffset > fileSize || header->NameTableSize > fileSize - header->NameTableOffset)
+        return;
+    // a table ending in NUL terminates every name that starts inside it
+    const char* names = reinterpret_cast<const char*>(m_File.GetData() + header->NameTableOffset);
+    if (header->NameTableSize > 0 && names[header->NameTableSize - 1] != '\0')
+        return;
+
+    m_Entries = reinterpret_cast<const AssetArchiveEntry*>(m_File.GetData() + sizeof(AssetArchiveHeader));
+    m_EntryCount = header->EntryCount;
+    m_Names = names;
+    m_NamesSize = header->NameTableSize;
+}
+
+uint64_t AssetArchive::HashName(std::string_view name)
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : name)
+    {
+        hash ^= (unsigned char)c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+AssetView AssetArchive::Find(std::string_view name) const
+{
+    AssetView view;
+    if (!IsOpen())
+        return view;
+
+    uint64_t hash = HashName(name);
+    const AssetArchiveEntry* end = m_Entries + m_EntryCount;
+    const AssetArchiveEntry* it = std::lower_bound(m_Entries, end, hash,
+        [](const AssetArchiveEntry& entry, uint64_t value) { return entry.NameHash < value; });
+
+    for (; it != end && it->NameHash == hash; ++it)
+    {
+        if (it->NameOffset >= m_NamesSize || name != std::string_view(m_Names + it->NameOffset))
+            continue;
+        const uint64_t fileSize = m_File.GetSize();
+        if (it->Offset > fileSize || it->Size > fileSize - it->Offset)
+            return view;
+        // decoded pixels must all be there, in a size a texture can take
+        if ((AssetEncoding)it->Encoding == AssetEncoding::RGBA8
+            && (it->Width == 0 || it->Height == 0 || it->Width > INT_MAX || it->Height > INT_MAX
+                || (uint64_t)it->Width * it->Height > it->Size / 4))
+            return view;
+
+        view.Data = m_File.GetData() + it->Offset;
+        view.Size = (size_t)it->Size;
+        view.Encoding = (AssetEncoding)it->Encoding;
+        view.Width = (int)it->Width;
+        view.Height = (int)it->Height;
+        return view;
+    }
+    return view;
+}
+
+void AssetArchiveWriter::Add(const std::string &name, std::vector<unsigned char> data, AssetEncoding encoding,
+                             uint32_t width, uint32_t height)
+{
+    m_Assets.push_back({ name, std::move(data), encoding, width, height });
+}
+
+bool AssetArchiveWriter::Write(const std::string &path) const
+{
+    std::vector<const PendingAsset*> sorted;
+    for (const PendingAsset& asset : m_Assets)
+        sorted.push_back(&asset);
+    std::sort(sorted.begin(), sorted.end(), [](const PendingAsset* a, const PendingAsset* b) {
+        return AssetArchive::HashName(a->Name) < AssetArchive::HashName(b->Name);
+    });
+
+    std::string names;
+    std::vector<AssetArchiveEntry> entries;
+    for (const PendingAsset* asset : sorted)
+    {
+        AssetArchiveEntry entry;
+        entry.NameHash = AssetArchive::HashName(asset->Name);
+        entry.Offset = 0;
+        entry.Size = asset->Data.size();
+        entry.Encoding = (uint32_t)asset->Encoding;
+        entry.NameOffset = (uint32_t)names.size();
+        entry.Width = asset->Width;
+        entry.Height = asset->Height;
+        entries.push_back(entry);
+        names += asset->Name;
+        names += '\0';
+    }
+
+    auto align = [](uint64_t offset) {
+        return (offset + AssetArchive::s_Alignment - 1) & ~(AssetArchive::s_Alignment - 1);
+    };
+
+    AssetArchiveHeader header;
+    std::memcpy(header.Magic, AssetArchive::s_Magic, sizeof(header.Magic));
+    header.Version = AssetArchive::s_Version;
+    header.EntryCount = (uint32_t)entries.size();
+    header.NameTableOffset = sizeof(AssetArchiveHeader) + entries.size() * sizeof(AssetArchiveEntry);
+    header.NameTableSize = names.size();
+
+    uint64_t offset = align(header.NameTableOffset + header.NameTableSize);
+    for (AssetArchiveEntry& entry : entries)
+    {
+        entry.Offset = offset;
+        offset = align(offset + entry.Size);
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(AssetArchiveEntry));
+    out.write(names.data(), names.size());
+
+    uint64_t position = header.NameTableOffset + header.NameTableSize;
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        std::string padding(entries[i].Offset - position, '\0');
+        out.write(padding.data(), padding.size());
+        out.write(reinterpret_cast<const char*>(sorted[i]->Data.data()), sorted[i]->Data.size());
+        position = entries[i].Offset + entries[i].Size;
+    }
+    return (bool)out;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Single-file asset pack. Layout:
+//   AssetArchiveHeader
+//   AssetArchiveEntry[EntryCount], sorted by NameHash
+//   name table (NUL-terminated paths)
+//   payloads, each starting on a 4 KiB boundary
+// At runtime the whole file is one read-only mapping and every asset is a
+// view into it.
+
+enum class AssetEncoding : uint32_t
+{
+    RAW = 0,    // bytes used as-is (shader source)
+    IMAGE = 1,  // compressed image, decoded with stbi_load_from_memory
+    RGBA8 = 2   // decoded pixels, rows bottom-up, Width * Height * 4 bytes
+};
+
+struct AssetArchiveHeader
+{
+    char Magic[8];
+    uint32_t Version;
+    uint32_t EntryCount;
+    uint64_t NameTableOffset;
+    uint64_t NameTableSize;
+};
+
+struct AssetArchiveEntry
+{
+    uint64_t NameHash;
+    uint64_t Offset;
+    uint64_t Size;
+    uint32_t Encoding;
+    uint32_t NameOffset;
+    uint32_t Width;
+    uint32_t Height;
+};
+
+struct AssetView
+{
+    const unsigned char* Data = nullptr;
+    size_t Size = 0;
+    AssetEncoding Encoding = AssetEncoding::RAW;
+    int Width = 0;
+    int Height = 0;
+
+    inline bool IsValid() const { return Data != nullptr; }
+    inline std::string_view GetText() const { return std::string_view(reinterpret_cast<const char*>(Data), Size); }
+};
+
+class AssetArchive
+{
+private:
+    MappedFile m_File;
+    const AssetArchiveEntry* m_Entries;
+    uint32_t m_EntryCount;
+    const char* m_Names;
+    uint64_t m_NamesSize;
+public:
+    static const char s_Magic[8];
+    static const uint32_t s_Version = 1;
+    static const uint64_t s_Alignment = 4096;
+
+    AssetArchive();
+    explicit AssetArchive(const std::string& path);
+
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+
+    inline bool IsOpen() const { return m_Entries != nullptr; }
+    inline uint32_t GetEntryCount() const { return m_EntryCount; }
+
+    AssetView Find(std::string_view name) const;
+
+    static uint64_t HashName(std::string_view name);
+};
+
+// Builds an archive from loose files; used by the pack_assets tool.
+class AssetArchiveWriter
+{
+private:
+    struct PendingAsset
+    {
+        std::string Name;
+        std::vector<unsigned char> Data;
+        AssetEncoding Encoding;
+        uint32_t Width, Height;
+    };
+    std::vector<PendingAsset> m_Assets;
+public:
+    void Add(const std::string& name, std::vector<unsigned char> data, AssetEncoding encoding,
+             uint32_t width = 0, uint32_t height = 0);
+    bool Write(const std::string& path) const;
+};
@@ -0,0 +1,146 @@
+#include "BatchTransform.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BATCH_TRANSFORM_SSE
+#if defined(__GNUC__) || defined(__clang__)
+#include <immintrin.h>
+#define BATCH_TRANSFORM_AVX
+#endif
+#endif
+
+namespace {
+
+typedef void (*TransformFunction)(const glm::mat4& matrix, const SoaInput& in, const SoaOutput& out, size_t begin, size_t count);
+
+void TransformScalar(const glm::mat4& m, const SoaInput& in, const SoaOutput& out, size_t begin, size_t count)
+{
+    float rows[4][4];
+    for (int c = 0; c < 4; c++)
+        for (int r = 0; r < 4; r++)
+            rows[r][c] = m[c][r];
+    float* outputs[4] = { out.X, out.Y, out.Z, out.W };
+
+    for (size_t i = begin; i < count; i++)
+    {
+        float x = in.X[i];
+        float y = in.Y[i];
+        float z = in.Z ? in.Z[i] : 0.0f;
+        float w = in.W ? in.W[i] : 1.0f;
+        // all four components are read before any store, so in-place is safe
+        float result[4];
+        for (int r = 0; r < 4; r++)
+            result[r] = rows[r][0] * x + rows[r][1] * y + rows[r][2] * z + rows[r][3] * w;
+        for (int r = 0; r < 4; r++)
+            if (outputs[r])
+                outputs[r][i] = result[r];
+    }
+}
+
+#ifdef BATCH_TRANSFORM_SSE
+
+void TransformSse(const glm::mat4& m, const SoaInput& in, const SoaOutput& out, size_t begin, size_t count)
+{
+    __m128 columns[4][4];
+    for (int c = 0; c < 4; c++)
+        for (int r = 0; r < 4; r++)
+            columns[c][r] = _mm_set1_ps(m[c][r]);
+    float* outputs[4] = { out.X, out.Y, out.Z, out.W };
+
+    size_t i = begin;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(in.X + i);
+        __m128 y = _mm_loadu_ps(in.Y + i);
+        __m128 z = in.Z ? _mm_loadu_ps(in.Z + i) : _mm_setzero_ps();
+        __m128 w = in.W ? _mm_loadu_ps(in.W + i) : _mm_set1_ps(1.0f);
+        __m128 r[4];
+        for (int c = 0; c < 4; c++)
+        {
+            __m128 a = _mm_add_ps(_mm_mul_ps(columns[0][c], x), _mm_mul_ps(columns[1][c], y));
+            __m128 b = _mm_add_ps(_mm_mul_ps(columns[2][c], z), _mm_mul_ps(columns[3][c], w));
+            r[c] = _mm_add_ps(a, b);
+        }
+        for (int c = 0; c < 4; c++)
+            if (outputs[c])
+                _mm_storeu_ps(outputs[c] + i, r[c]);
+    }
+    TransformScalar(m, in, out, i, count);
+}
+
+#endif
+
+#ifdef BATCH_TRANSFORM_AVX
+
+// one row of the matrix per output component, 8 vectors per iteration. The
+// loop is instantiated per z/w presence so absent terms cost nothing: without
+// w the translation column is the starting value.
+template<bool HasZ, bool HasW>
+__attribute__((target("avx,fma")))
+void TransformAvxLoop(const glm::mat4& m, const SoaInput& in, const SoaOutput& out, size_t begin, size_t count)
+{
+    __m256 columns[4][4];
+    for (int c = 0; c < 4; c++)
+        for (int r = 0; r < 4; r++)
+            columns[c][r] = _mm256_set1_ps(m[c][r]);
+    float* outputs[4] = { out.X, out.Y, out.Z, out.W };
+
+    size_t i = begin;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(in.X + i);
+        __m256 y = _mm256_loadu_ps(in.Y + i);
+        __m256 r[4];
+        for (int c = 0; c < 4; c++)
+        {
+            __m256 acc = columns[3][c];
+            if (HasW)
+                acc = _mm256_mul_ps(acc, _mm256_loadu_ps(in.W + i));
+            if (HasZ)
+                acc = _mm256_fmadd_ps(columns[2][c], _mm256_loadu_ps(in.Z + i), acc);
+            acc = _mm256_fmadd_ps(columns[1][c], y, acc);
+            r[c] = _mm256_fmadd_ps(columns[0][c], x, acc);
+        }
+        for (int c = 0; c < 4; c++)
+            if (outputs[c])
+                _mm256_storeu_ps(outputs[c] + i, r[c]);
+    }
+    TransformScalar(m, in, out, i, count);
+}
+
+void TransformAvx(const glm::mat4& m, const SoaInput& in, const SoaOutput& out, size_t begin, size_t count)
+{
+    if (in.Z)
+        (in.W ? TransformAvxLoop<true, true> : TransformAvxLoop<true, false>)(m, in, out, begin, count);
+    else
+        (in.W ? TransformAvxLoop<false, true> : TransformAvxLoop<false, false>)(m, in, out, begin, count);
+}
+
+#endif
+
+TransformFunction Select(SimdLevel level)
+{
+    level = CpuFeatures::Get().Clamp(level);
+#ifdef BATCH_TRANSFORM_AVX
+    if (level >= SimdLevel::AVX)
+        return TransformAvx;
+#endif
+#ifdef BATCH_TRANSFORM_SSE
+    if (level >= SimdLevel::SSE)
+        return TransformSse;
+#endif
+    return TransformScalar;
+}
+
+}
+
+void BatchTransform::Transform(const glm::mat4& matrix, const SoaInput& in, const SoaOutput& out, size_t count)
+{
+    static const TransformFunction best = Select(SimdLevel::AVX);
+    best(matrix, in, out, 0, count);
+}
+
+void BatchTransform::Transform(SimdLevel level, const glm::mat4& matrix, const SoaInput& in, const SoaOutput& out, size_t count)
+{
+    Select(level)(matrix, in, out, 0, count);
+}
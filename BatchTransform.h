@@ -0,0 +1,40 @@
+#pragma once
+
+#include "CpuFeatures.h"
+#include "glm/glm.hpp"
+
+#include <cstddef>
+
+// Structure-of-arrays vectors: one float stream per component. Z and W are
+// optional and read as 0 and 1 when null, i.e. 2D points on the z = 0 plane.
+struct SoaInput
+{
+    const float* X = nullptr;
+    const float* Y = nullptr;
+    const float* Z = nullptr;
+    const float* W = nullptr;
+};
+
+// any stream may be null to skip computing that component
+struct SoaOutput
+{
+    float* X = nullptr;
+    float* Y = nullptr;
+    float* Z = nullptr;
+    float* W = nullptr;
+};
+
+// Applies one mat4 to many vectors per call -- 8 per iteration with AVX/FMA,
+// 4 with SSE, scalar otherwise -- for CPU-side culling and instance buffer
+// builds where per-vector glm calls would dominate. The level is picked at
+// runtime from CpuFeatures. Streams need no particular alignment, and an
+// output stream may be the same array as an input stream (but must not
+// partially overlap one).
+class BatchTransform
+{
+public:
+    static void Transform(const glm::mat4& matrix, const SoaInput& in, const SoaOutput& out, size_t count);
+
+    // a given level, capped to what the CPU supports (for benchmarks)
+    static void Transform(SimdLevel level, const glm::mat4& matrix, const SoaInput& in, const SoaOutput& out, size_t count);
+};
@@ -0,0 +1,249 @@
+#include "Board.h"
+#include "MinePlacement.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <random>
+#include <vector>
+
+namespace {
+
+// every row starts on a cache line, with the left border cell just before it
+const size_t s_RowLead = AlignedBuffer::s_CacheLine;
+
+inline int LowestBit(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int bit = 0;
+    while (!(word & 1))
+    {
+        word >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+// runs function(0) .. function(count - 1), spread over the pool if there is one
+template<typename Function>
+void ForEachBand(ThreadPool* pool, size_t count, const Function& function)
+{
+    if (!pool || pool->GetThreadCount() <= 1 || count <= 1)
+    {
+        for (size_t i = 0; i < count; i++)
+            function(i);
+        return;
+    }
+    for (size_t i = 0; i < count; i++)
+        pool->Submit([&function, i] { function(i); });
+    pool->Wait();
+}
+
+}
+
+Board::Board(int width, int height, int mineCount)
+    : m_Width(std::max(width, 1)), m_Height(std::max(height, 1)), m_MineCount(0),
+      m_Stride(0), m_Origin(nullptr), m_Mines(std::max(width, 1), std::max(height, 1)),
+      m_Seed(0), m_RevealedCount(0), m_FlagCount(0), m_Exploded(false)
+{
+    m_MineCount = (int)std::min<size_t>((size_t)std::max(mineCount, 0), GetCellCount());
+    // at least 8 border bytes after a row, so a word read starting at any
+    // cell or its right neighbour stays inside the row, bottom border included
+    m_Stride = (s_RowLead + m_Width + 8 + AlignedBuffer::s_CacheLine - 1) & ~(AlignedBuffer::s_CacheLine - 1);
+    // one border row above and below
+    m_Cells = AlignedBuffer((size_t)(m_Height + 2) * m_Stride);
+    // AlignedBuffer reports the failure and stays empty; fail the way
+    // std::vector would rather than write through a null origin
+    if (!m_Cells.GetData())
+        throw std::bad_alloc();
+    m_Origin = m_Cells.GetData() + m_Stride + s_RowLead;
+
+    // interior cells start zeroed: hidden, no mine, count 0
+    const unsigned char border = BORDER_BIT | ((int)CellState::REVEALED << STATE_SHIFT);
+    unsigned char* base = m_Cells.GetData();
+    std::fill(base, base + m_Stride, border);
+    std::fill(base + (size_t)(m_Height + 1) * m_Stride, base + (size_t)(m_Height + 2) * m_Stride, border);
+    for (int y = 0; y < m_Height; y++)
+    {
+        unsigned char* row = m_Origin + (size_t)y * m_Stride;
+        std::fill(row - s_RowLead, row, border);
+        std::fill(row + m_Width, row - s_RowLead + m_Stride, border);
+    }
+    m_RevealEngine.Reserve(m_Width, m_Height);
+}
+
+uint64_t Board::NewSeed()
+{
+    std::random_device device;
+    uint64_t seed = ((uint64_t)device() << 32) | device();
+    return seed ^ (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+void Board::Generate(uint64_t seed, ThreadPool* pool)
+{
+    m_Seed = seed;
+    std::vector<MineBand> bands = MinePlacement::SplitBands(m_Width, m_Height, (size_t)m_MineCount, seed);
+
+    // every band's mines have to be down before any band counts its edge rows
+    ForEachBand(pool, bands.size(), [&](size_t i) { MinePlacement::PlaceBand(m_Mines, bands[i], seed, i); });
+    ForEachBand(pool, bands.size(), [&](size_t i) { FinishRows(bands[i].FirstRow, bands[i].EndRow); });
+
+    m_RevealedCount = 0;
+    m_FlagCount = 0;
+    m_Exploded = false;
+}
+
+void Board::FinishRows(int firstRow, int endRow)
+{
+    // the counts overwrite every cell byte, which leaves all cells hidden
+    m_Mines.CountNeighbors(m_Origin, m_Stride, firstRow, endRow);
+    for (int y = firstRow; y < endRow; y++)
+    {
+        const uint64_t* words = m_Mines.GetRow(y);
+        unsigned char* row = m_Origin + (size_t)y * m_Stride;
+        for (size_t k = 0; k < m_Mines.GetWordsPerRow(); k++)
+        {
+            for (uint64_t word = words[k]; word; word &= word - 1)
+                row[k * 64 + LowestBit(word)] |= MINE_BIT;
+        }
+    }
+}
+
+size_t Board::Reveal(int x, int y, ThreadPool* pool)
+{
+    m_DirtyChunks.clear();
+    if (!Contains(x, y))
+        return 0;
+    ptrdiff_t start = (ptrdiff_t)y * (ptrdiff_t)m_Stride + x;
+    if (StateOf(m_Origin[start]) != CellState::HIDDEN)
+        return 0;
+    if (m_Origin[start] & MINE_BIT)
+    {
+        SetState(m_Origin[start], CellState::MEME);
+        m_Exploded = true;
+        m_DirtyChunks.push_back((uint32_t)(y / CHUNK_SIZE) * GetChunkColumns() + x / CHUNK_SIZE);
+        return 0;
+    }
+
+    size_t revealed = m_RevealEngine.Reveal(m_Origin, m_Stride, x, y, m_DirtyChunks, pool);
+    m_RevealedCount += revealed;
+    return revealed;
+}
+
+bool Board::ToggleFlag(int x, int y)
+{
+    if (!Contains(x, y))
+        return false;
+    unsigned char& cell = m_Origin[(ptrdiff_t)y * (ptrdiff_t)m_Stride + x];
+    CellState state = StateOf(cell);
+    if (state == CellState::HIDDEN)
+    {
+        SetState(cell, CellState::FLAGGED);
+        m_FlagCount++;
+        return true;
+    }
+    if (state == CellState::FLAGGED)
+    {
+        SetState(cell, CellState::HIDDEN);
+        m_FlagCount--;
+        return true;
+    }
+    return false;
+}
+
+int Board::CountAdjacentMines(int x, int y) const
+{
+    const unsigned char* center = m_Origin + (ptrdiff_t)y * (ptrdiff_t)m_Stride + x;
+    int count = 0;
+    for (int dy = -1; dy <= 1; dy++)
+    {
+        const unsigned char* row = center + (ptrdiff_t)dy * (ptrdiff_t)m_Stride;
+        count += ((row[-1] & MINE_BIT) != 0) + ((row[1] & MINE_BIT) != 0) + (dy != 0 && (row[0] & MINE_BIT) != 0);
+    }
+    return count;
+}
+
+void Board::AdjustNeighborCounts(int x, int y, int delta)
+{
+    unsigned char* center = m_Origin + (ptrdiff_t)y * (ptrdiff_t)m_Stride + x;
+    for (int dy = -1; dy <= 1; dy++)
+    {
+        unsigned char* row = center + (ptrdiff_t)dy * (ptrdiff_t)m_Stride;
+        for (int dx = -1; dx <= 1; dx++)
+        {
+            // mines carry no count and the border none at all; a count
+            // never leaves 0..8, so adding to the byte stays in its nibble
+            if ((dx == 0 && dy == 0) || (row[dx] & (MINE_BIT | BORDER_BIT)))
+                continue;
+            row[dx] = (unsigned char)(row[dx] + delta);
+        }
+    }
+}
+
+bool Board::AddMine(int x, int y)
+{
+    if (!Contains(x, y))
+        return false;
+    unsigned char& cell = m_Origin[(ptrdiff_t)y * (ptrdiff_t)m_Stride + x];
+    if ((cell & MINE_BIT) || StateOf(cell) == CellState::REVEALED)
+        return false;
+    cell = (unsigned char)((cell & STATE_MASK) | MINE_BIT);
+    m_Mines.Set(x, y, true);
+    AdjustNeighborCounts(x, y, 1);
+    m_MineCount++;
+    return true;
+}
+
+bool Board::RemoveMine(int x, int y)
+{
+    if (!Contains(x, y))
+        return false;
+    unsigned char& cell = m_Origin[(ptrdiff_t)y * (ptrdiff_t)m_Stride + x];
+    if (!(cell & MINE_BIT) || StateOf(cell) == CellState::MEME)
+        return false;
+    cell = (unsigned char)((cell & STATE_MASK) | CountAdjacentMines(x, y));
+    m_Mines.Set(x, y, false);
+    AdjustNeighborCounts(x, y, -1);
+    m_MineCount--;
+    return true;
+}
+
+bool Board::MoveMine(int fromX, int fromY, int toX, int toY)
+{
+    if (!Contains(fromX, fromY) || !Contains(toX, toY))
+        return false;
+    unsigned char from = GetCell(fromX, fromY);
+    unsigned char to = GetCell(toX, toY);
+    if (!(from & MINE_BIT) || StateOf(from) == CellState::MEME || (to & MINE_BIT) || StateOf(to) == CellState::REVEALED)
+        return false;
+    RemoveMine(fromX, fromY);
+    AddMine(toX, toY);
+    return true;
+}
+
+bool Board::FindFreeCell(int& x, int& y) const
+{
+    // 64 cells per step; bits past the width are zero in the bitboard, so
+    // they are masked off the last word
+    size_t lastWord = m_Mines.GetWordsPerRow() - 1;
+    uint64_t lastMask = (m_Width & 63) ? ((uint64_t)1 << (m_Width & 63)) - 1 : ~(uint64_t)0;
+    for (int row = 0; row < m_Height; row++)
+    {
+        const uint64_t* words = m_Mines.GetRow(row);
+        for (size_t k = 0; k <= lastWord; k++)
+        {
+            uint64_t free = ~words[k] & (k == lastWord ? lastMask : ~(uint64_t)0);
+            if (free)
+            {
+                x = (int)(k * 64) + LowestBit(free);
+                y = row;
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "AlignedBuffer.h"
+#include "MineBitboard.h"
+#include "RevealEngine.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+enum class CellState : unsigned char
+{
+    HIDDEN = 0, REVEALED, MEME, FLAGGED
+};
+
+// Minesweeper board of runtime size. Every cell is one byte (see the layout
+// constants) in a single cache-line aligned allocation, huge-page backed for
+// large boards, with a ring of border cells around the board: border cells
+// read as revealed, mine-free and carry BORDER_BIT, so code walking the 8
+// neighbors of any cell needs no bounds checks. The mine layer is mirrored in
+// a MineBitboard, which the neighbor counts are computed from.
+class Board
+{
+public:
+    // cell byte layout
+    static const unsigned char COUNT_MASK = 0x0F;
+    static const unsigned char MINE_BIT = 0x10;
+    static const int STATE_SHIFT = 5;
+    static const unsigned char STATE_MASK = 0x60;
+    static const unsigned char BORDER_BIT = 0x80;
+    // side of the square chunks changes are reported in
+    static const int CHUNK_SIZE = 64;
+private:
+    int m_Width;
+    int m_Height;
+    int m_MineCount;
+    size_t m_Stride;            // bytes per padded row
+    AlignedBuffer m_Cells;
+    unsigned char* m_Origin;    // cell (0, 0)
+    MineBitboard m_Mines;
+    uint64_t m_Seed;
+    size_t m_RevealedCount;
+    size_t m_FlagCount;
+    bool m_Exploded;
+    RevealEngine m_RevealEngine;
+    std::vector<uint32_t> m_DirtyChunks;
+
+    inline CellState StateOf(unsigned char cell) const { return (CellState)((cell & STATE_MASK) >> STATE_SHIFT); }
+    inline void SetState(unsigned char& cell, CellState state)
+    {
+        cell = (unsigned char)((cell & ~STATE_MASK) | ((int)state << STATE_SHIFT));
+    }
+
+    // counts and mine bits of rows [firstRow, endRow) from the bitboard
+    void FinishRows(int firstRow, int endRow);
+    // mines among the 8 neighbors, read from the cell bytes
+    int CountAdjacentMines(int x, int y) const;
+    // adds delta to the count of every mine-free neighbor
+    void AdjustNeighborCounts(int x, int y, int delta);
+public:
+    // an empty, all hidden board; mineCount is capped to the number of cells
+    Board(int width, int height, int mineCount);
+
+    Board(const Board&) = delete;
+    Board& operator=(const Board&) = delete;
+
+    inline int GetWidth() const { return m_Width; }
+    inline int GetHeight() const { return m_Height; }
+    inline int GetMineCount() const { return m_MineCount; }
+    inline size_t GetCellCount() const { return (size_t)m_Width * m_Height; }
+    inline int GetChunkColumns() const { return (m_Width + CHUNK_SIZE - 1) / CHUNK_SIZE; }
+    inline int GetChunkRows() const { return (m_Height + CHUNK_SIZE - 1) / CHUNK_SIZE; }
+
+    inline bool Contains(int x, int y) const { return x >= 0 && x < m_Width && y >= 0 && y < m_Height; }
+
+    // raw cell bytes: cell (x, y) is GetCellData()[y * GetStride() + x], and
+    // the border is at x or y of -1 and width/height; a row is followed by at
+    // least 8 border bytes
+    inline const unsigned char* GetCellData() const { return m_Origin; }
+    inline size_t GetStride() const { return m_Stride; }
+    inline unsigned char GetCell(int x, int y) const { return m_Origin[(ptrdiff_t)y * (ptrdiff_t)m_Stride + x]; }
+    inline const MineBitboard& GetMines() const { return m_Mines; }
+
+    inline CellState GetState(int x, int y) const { return StateOf(GetCell(x, y)); }
+    inline bool IsMine(int x, int y) const { return (GetCell(x, y) & MINE_BIT) != 0; }
+    inline int GetNeighborCount(int x, int y) const { return GetCell(x, y) & COUNT_MASK; }
+
+    inline size_t GetRevealedCount() const { return m_RevealedCount; }
+    inline size_t GetFlagCount() const { return m_FlagCount; }
+    inline bool IsExploded() const { return m_Exploded; }
+    // every safe cell revealed
+    inline bool IsCleared() const { return !m_Exploded && m_RevealedCount == GetCellCount() - (size_t)m_MineCount; }
+
+    // Places the mines from a seed, counts neighbors and hides every cell;
+    // the same size, mine count and seed always give the same board. Both
+    // steps run per band of rows (see MinePlacement), on the pool's threads
+    // when one is given; a band reads its neighbors' edge rows of the
+    // bitboard but only writes its own rows, so no locking is needed.
+    void Generate(uint64_t seed, ThreadPool* pool = nullptr);
+    // seed of the last Generate, to recreate or report a board
+    inline uint64_t GetSeed() const { return m_Seed; }
+    // a fresh nondeterministic seed
+    static uint64_t NewSeed();
+
+    // Reveals a hidden cell. A cell without adjacent mines floods outwards
+    // over its neighbors (see RevealEngine), on the pool's threads when the
+    // opening is large and a pool is given; a mine is shown as MEME and
+    // explodes the board. Returns the number of cells revealed.
+    size_t Reveal(int x, int y, ThreadPool* pool = nullptr);
+    // Chunks changed by the last Reveal, as chunkY * GetChunkColumns() +
+    // chunkX, for redrawing only those. A chunk is listed once, in row order.
+    inline const std::vector<uint32_t>& GetDirtyChunks() const { return m_DirtyChunks; }
+    // flags a hidden cell or unflags a flagged one; false for anything else
+    bool ToggleFlag(int x, int y);
+
+    // Board editing, in constant time: each change updates the mine bit,
+    // the bitboard, the counts of the 3x3 neighborhood and the mine count.
+    // Cell states are kept, so a flag stays where it was. After an edit the
+    // board no longer matches GetSeed().
+    // puts a mine on a cell that is not revealed; false if it has one
+    bool AddMine(int x, int y);
+    // takes the mine off a cell unless it has exploded
+    bool RemoveMine(int x, int y);
+    // RemoveMine(from) then AddMine(to); changes nothing unless both can be done
+    bool MoveMine(int fromX, int fromY, int toX, int toY);
+    // first cell without a mine in row order; false if every cell has one
+    bool FindFreeCell(int& x, int& y) const;
+};
@@ -0,0 +1,54 @@
+#include "CpuFeatures.h"
+
+#include <iostream>
+
+namespace {
+
+CpuFeatures Detect()
+{
+    CpuFeatures features;
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    // also checks that the OS saves the YMM registers
+    __builtin_cpu_init();
+    features.SSE2 = __builtin_cpu_supports("sse2");
+    features.AVX = __builtin_cpu_supports("avx");
+    features.AVX2 = __builtin_cpu_supports("avx2");
+    features.FMA = __builtin_cpu_supports("fma");
+#endif
+    return features;
+}
+
+}
+
+const CpuFeatures& CpuFeatures::Get()
+{
+    static const CpuFeatures features = Detect();
+    return features;
+}
+
+SimdLevel CpuFeatures::GetBestLevel() const
+{
+    if (AVX && FMA)
+        return SimdLevel::AVX;
+    if (SSE2)
+        return SimdLevel::SSE;
+    return SimdLevel::SCALAR;
+}
+
+SimdLevel CpuFeatures::Clamp(SimdLevel level) const
+{
+    SimdLevel best = GetBestLevel();
+    return (int)level < (int)best ? level : best;
+}
+
+const char* CpuFeatures::GetLevelName(SimdLevel level)
+{
+    static const char* names[] = { "scalar", "sse", "avx" };
+    return (int)level < (int)SimdLevel::COUNT ? names[(int)level] : "unknown";
+}
+
+void CpuFeatures::Print() const
+{
+    std::cout << "cpu: sse2 " << SSE2 << ", avx " << AVX << ", avx2 " << AVX2 << ", fma " << FMA
+              << " (using " << GetLevelName(GetBestLevel()) << ")" << std::endl;
+}
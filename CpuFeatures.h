@@ -0,0 +1,27 @@
+#pragma once
+
+enum class SimdLevel
+{
+    SCALAR = 0, SSE, AVX, COUNT
+};
+
+// x86 instruction set extensions of the host, detected once. Kernels built for
+// a newer level than the compiler targets by default are compiled per function
+// (target attributes) and must only be called when these say so.
+struct CpuFeatures
+{
+    bool SSE2 = false;
+    bool AVX = false;
+    bool AVX2 = false;
+    bool FMA = false;
+
+    static const CpuFeatures& Get();
+
+    // AVX means AVX + FMA, which is what the 256-bit float kernels use
+    SimdLevel GetBestLevel() const;
+    // level capped to what this CPU supports
+    SimdLevel Clamp(SimdLevel level) const;
+
+    static const char* GetLevelName(SimdLevel level);
+    void Print() const;
+};
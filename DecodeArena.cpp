@@ -0,0 +1,204 @@
+#include "DecodeArena.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+const size_t s_Alignment = 16;
+const size_t s_Granularity = 1 << 20;
+const size_t s_NoBlock = (size_t)-1;
+
+inline size_t AlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}
+
+DecodeArena::DecodeArena()
+    : m_Base(nullptr), m_Capacity(0), m_Offset(0), m_Newest(s_NoBlock),
+      m_LiveBlocks(0), m_HeapLiveBytes(0), m_CyclePeak(0)
+{
+    static_assert(sizeof(BlockHeader) % s_Alignment == 0, "block header must keep payloads aligned");
+}
+
+DecodeArena::~DecodeArena()
+{
+    std::free(m_Base);
+}
+
+DecodeArena& DecodeArena::Get()
+{
+    static thread_local DecodeArena arena;
+    return arena;
+}
+
+bool DecodeArena::Owns(const void* block) const
+{
+    const unsigned char* p = static_cast<const unsigned char*>(block);
+    return m_Base && p >= m_Base && p < m_Base + m_Capacity;
+}
+
+void* DecodeArena::HeapAllocate(size_t size)
+{
+    m_Stats.HeapCalls++;
+    BlockHeader* header = static_cast<BlockHeader*>(std::malloc(sizeof(BlockHeader) + size));
+    if (!header)
+        return nullptr;
+    header->Size = size;
+    header->Previous = s_NoBlock;
+    m_HeapLiveBytes += size;
+    return header + 1;
+}
+
+void* DecodeArena::Allocate(size_t size)
+{
+    m_Stats.Allocations++;
+    size_t needed = sizeof(BlockHeader) + AlignUp(size, s_Alignment);
+    m_CyclePeak = std::max(m_CyclePeak, m_Offset + m_HeapLiveBytes + needed);
+    void* block;
+    if (needed <= m_Capacity - m_Offset)
+    {
+        BlockHeader* header = reinterpret_cast<BlockHeader*>(m_Base + m_Offset);
+        header->Size = size;
+        header->Previous = m_Newest;
+        m_Newest = m_Offset;
+        m_Offset += needed;
+        block = header + 1;
+    }
+    else
+    {
+        block = HeapAllocate(size);
+        if (!block)
+            return nullptr;
+    }
+
+    m_LiveBlocks++;
+    m_Stats.LiveBytes += size;
+    return block;
+}
+
+void* DecodeArena::Reallocate(void* block, size_t size)
+{
+    if (!block)
+        return Allocate(size);
+
+    m_Stats.Reallocations++;
+    BlockHeader* header = static_cast<BlockHeader*>(block) - 1;
+    size_t oldSize = header->Size;
+
+    if (Owns(block))
+    {
+        size_t start = (size_t)(reinterpret_cast<unsigned char*>(header) - m_Base);
+        size_t end = start + sizeof(BlockHeader) + AlignUp(size, s_Alignment);
+        if (start == m_Newest && end <= m_Capacity)
+        {
+            // newest block: move the bump pointer instead of copying
+            m_Stats.InPlaceGrows++;
+            header->Size = size;
+            m_Offset = end;
+            m_Stats.LiveBytes += size - oldSize;
+            m_CyclePeak = std::max(m_CyclePeak, m_Offset + m_HeapLiveBytes);
+            return block;
+        }
+    }
+    else
+    {
+        m_Stats.HeapCalls++;
+        BlockHeader* grown = static_cast<BlockHeader*>(std::realloc(header, sizeof(BlockHeader) + size));
+        if (!grown)
+            return nullptr;
+        grown->Size = size;
+        m_HeapLiveBytes += size - oldSize;
+        m_Stats.LiveBytes += size - oldSize;
+        m_CyclePeak = std::max(m_CyclePeak, m_Offset + m_HeapLiveBytes);
+        return grown + 1;
+    }
+
+    // not the newest block: stb_image only ever grows, so move it. Allocate and
+    // Free count this as one of each; undo that so stats show one reallocation.
+    void* moved = Allocate(size);
+    if (!moved)
+        return nullptr;
+    std::memcpy(moved, block, std::min(oldSize, size));
+    Free(block);
+    m_Stats.Allocations--;
+    m_Stats.Frees--;
+    return moved;
+}
+
+void DecodeArena::Free(void* block)
+{
+    if (!block)
+        return;
+
+    m_Stats.Frees++;
+    BlockHeader* header = static_cast<BlockHeader*>(block) - 1;
+    m_Stats.LiveBytes -= header->Size;
+
+    if (Owns(block))
+    {
+        size_t start = (size_t)(reinterpret_cast<unsigned char*>(header) - m_Base);
+        if (start == m_Newest)
+        {
+            // last in, first out: hand the space straight back
+            m_Offset = start;
+            m_Newest = header->Previous;
+        }
+    }
+    else
+    {
+        m_Stats.HeapCalls++;
+        m_HeapLiveBytes -= header->Size;
+        std::free(header);
+    }
+
+    if (--m_LiveBlocks == 0)
+        Rewind();
+}
+
+void DecodeArena::Rewind()
+{
+    m_Stats.Rewinds++;
+    m_Stats.HighWaterBytes = std::max(m_Stats.HighWaterBytes, m_CyclePeak);
+
+    if (m_CyclePeak > m_Capacity)
+    {
+        // this decode spilled; size the buffer so the next one like it fits
+        size_t capacity = AlignUp(m_CyclePeak, s_Granularity);
+        unsigned char* base = static_cast<unsigned char*>(std::malloc(capacity));
+        m_Stats.HeapCalls += m_Base ? 2 : 1;
+        if (base)
+        {
+            std::free(m_Base);
+            m_Base = base;
+            m_Capacity = capacity;
+            m_Stats.CapacityBytes = capacity;
+        }
+    }
+
+    m_Offset = 0;
+    m_Newest = s_NoBlock;
+    m_CyclePeak = 0;
+}
+
+void DecodeArena::Release()
+{
+    if (m_LiveBlocks != 0)
+        return;
+    std::free(m_Base);
+    m_Base = nullptr;
+    m_Capacity = 0;
+    m_Stats.CapacityBytes = 0;
+}
+
+void DecodeArena::PrintStats() const
+{
+    std::cout << "decode arena: " << m_Stats.Rewinds << " decodes, " << m_Stats.Allocations << " allocs, "
+              << m_Stats.Reallocations << " reallocs (" << m_Stats.InPlaceGrows << " in place), "
+              << m_Stats.Frees << " frees, " << m_Stats.HeapCalls << " heap calls; capacity "
+              << m_Stats.CapacityBytes << " bytes (peak decode " << m_Stats.HighWaterBytes << ")" << std::endl;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+
+struct DecodeArenaStats
+{
+    unsigned long long Allocations = 0;
+    unsigned long long Reallocations = 0;
+    unsigned long long Frees = 0;
+    unsigned long long InPlaceGrows = 0;    // reallocations of the newest block, no copy
+    unsigned long long HeapCalls = 0;       // malloc/realloc/free that reached libc
+    unsigned long long Rewinds = 0;         // decodes completed (arena emptied)
+    size_t LiveBytes = 0;
+    size_t HighWaterBytes = 0;              // largest single-decode footprint seen
+    size_t CapacityBytes = 0;
+};
+
+// Per-thread bump allocator behind STBI_MALLOC/STBI_REALLOC/STBI_FREE (see
+// stb_image.cpp). Blocks are carved from one retained buffer; growing the newest
+// block happens in place, which covers the zlib output chain. Once every block
+// of a decode has been freed -- i.e. after the caller uploads the pixels and
+// calls stbi_image_free -- the arena rewinds to empty, and if the decode spilled
+// to the heap the buffer is regrown to that decode's high-water mark so the
+// next image of the same size makes no heap calls at all. Buffers returned by
+// stb_image must be freed on the thread that decoded them.
+class DecodeArena
+{
+private:
+    struct BlockHeader
+    {
+        size_t Size;
+        size_t Previous;    // offset of the block allocated before this one
+    };
+
+    unsigned char* m_Base;
+    size_t m_Capacity;
+    size_t m_Offset;
+    size_t m_Newest;        // header offset of the newest arena block, or npos
+    unsigned int m_LiveBlocks;
+    size_t m_HeapLiveBytes;
+    size_t m_CyclePeak;
+    DecodeArenaStats m_Stats;
+
+    DecodeArena();
+
+    bool Owns(const void* block) const;
+    void* HeapAllocate(size_t size);
+    void Rewind();
+public:
+    ~DecodeArena();
+
+    DecodeArena(const DecodeArena&) = delete;
+    DecodeArena& operator=(const DecodeArena&) = delete;
+
+    // the calling thread's arena
+    static DecodeArena& Get();
+
+    void* Allocate(size_t size);
+    void* Reallocate(void* block, size_t size);
+    void Free(void* block);
+
+    // drops the retained buffer; only valid while no decode is in flight
+    void Release();
+
+    inline const DecodeArenaStats& GetStats() const { return m_Stats; }
+    void PrintStats() const;
+};
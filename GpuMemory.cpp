@@ -0,0 +1,120 @@
+#include "GpuMemory.h"
+
+#include <algorithm>
+#include <iostream>
+
+GpuMemory::GpuMemory()
+    : m_Clock(0), m_Budget(0), m_Evicting(false)
+{
+}
+
+GpuMemory& GpuMemory::Get()
+{
+    static GpuMemory memory;
+    return memory;
+}
+
+unsigned int GpuMemory::Register(GpuResourceCategory category, size_t bytes)
+{
+    unsigned int id;
+    if (!m_FreeIDs.empty())
+    {
+        id = m_FreeIDs.back();
+        m_FreeIDs.pop_back();
+    }
+    else
+    {
+        m_Allocations.push_back({});
+        id = (unsigned int)m_Allocations.size();
+    }
+    m_Allocations[id - 1] = { category, bytes, ++m_Clock, true };
+
+    m_Stats.LiveBytes += bytes;
+    m_Stats.LiveAllocations++;
+    m_Stats.CategoryBytes[(int)category] += bytes;
+    m_Stats.CategoryCounts[(int)category]++;
+    m_Stats.HighWaterBytes = std::max(m_Stats.HighWaterBytes, m_Stats.LiveBytes);
+    return id;
+}
+
+void GpuMemory::Unregister(unsigned int id)
+{
+    if (id == 0 || !m_Allocations[id - 1].Live)
+        return;
+    Allocation& allocation = m_Allocations[id - 1];
+    m_Stats.LiveBytes -= allocation.Bytes;
+    m_Stats.LiveAllocations--;
+    m_Stats.CategoryBytes[(int)allocation.Category] -= allocation.Bytes;
+    m_Stats.CategoryCounts[(int)allocation.Category]--;
+    allocation.Live = false;
+    m_FreeIDs.push_back(id);
+}
+
+void GpuMemory::SetBudget(size_t bytes)
+{
+    m_Budget = bytes;
+    EnforceBudget();
+}
+
+void GpuMemory::EnforceBudget()
+{
+    if (m_Budget == 0 || m_Stats.LiveBytes <= m_Budget || !m_EvictionHandler || m_Evicting)
+        return;
+
+    // the handler usually destroys the resource, which re-enters Unregister
+    m_Evicting = true;
+    std::vector<unsigned int> candidates;
+    for (unsigned int i = 0; i < m_Allocations.size(); i++)
+        if (m_Allocations[i].Live)
+            candidates.push_back(i + 1);
+    std::sort(candidates.begin(), candidates.end(), [this](unsigned int a, unsigned int b) {
+        return m_Allocations[a - 1].LastUse < m_Allocations[b - 1].LastUse;
+    });
+
+    // bytes the handler promised to release later rather than right away
+    size_t pending = 0;
+    for (unsigned int id : candidates)
+    {
+        if (m_Stats.LiveBytes - std::min(pending, m_Stats.LiveBytes) <= m_Budget)
+            break;
+        const Allocation& allocation = m_Allocations[id - 1];
+        if (!allocation.Live || !m_EvictionHandler(id, allocation.Category, allocation.Bytes))
+            continue;
+        if (m_Allocations[id - 1].Live)
+            pending += m_Allocations[id - 1].Bytes;
+    }
+    m_Evicting = false;
+}
+
+size_t GpuMemory::GetAllocationSize(unsigned int id) const
+{
+    if (id == 0 || !m_Allocations[id - 1].Live)
+        return 0;
+    return m_Allocations[id - 1].Bytes;
+}
+
+const char* GpuMemory::GetCategoryName(GpuResourceCategory category)
+{
+    switch (category)
+    {
+        case GpuResourceCategory::VERTEX_BUFFER: return "vertex buffers";
+        case GpuResourceCategory::INDEX_BUFFER: return "index buffers";
+        case GpuResourceCategory::PIXEL_BUFFER: return "pixel buffers";
+        case GpuResourceCategory::TEXTURE: return "textures";
+        case GpuResourceCategory::FRAMEBUFFER: return "framebuffers";
+        default: return "unknown";
+    }
+}
+
+void GpuMemory::PrintStats() const
+{
+    std::cout << "gpu memory: " << m_Stats.LiveBytes << " bytes in " << m_Stats.LiveAllocations
+              << " allocations (peak " << m_Stats.HighWaterBytes << ")" << std::endl;
+    for (int i = 0; i < (int)GpuResourceCategory::COUNT; i++)
+    {
+        if (m_Stats.CategoryCounts[i] == 0)
+            continue;
+        std::cout << "  " << GetCategoryName((GpuResourceCategory)i) << ": " << m_Stats.CategoryBytes[i]
+                  << " bytes in " << m_Stats.CategoryCounts[i] << std::endl;
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+enum class GpuResourceCategory
+{
+    VERTEX_BUFFER = 0, INDEX_BUFFER, PIXEL_BUFFER, TEXTURE, FRAMEBUFFER, COUNT
+};
+
+struct GpuMemoryStats
+{
+    size_t LiveBytes = 0;
+    size_t HighWaterBytes = 0;
+    unsigned int LiveAllocations = 0;
+    size_t CategoryBytes[(int)GpuResourceCategory::COUNT] = {};
+    unsigned int CategoryCounts[(int)GpuResourceCategory::COUNT] = {};
+};
+
+// Process-wide accounting of video memory held by the GL wrappers. Each
+// resource registers its byte size when created and unregisters when
+// destroyed; Touch() on bind keeps a use stamp for LRU eviction. When a budget
+// is set and exceeded, the eviction handler is offered allocations oldest use
+// first, skipping those it declines, until the total fits again or none are
+// left. Like the GL calls it mirrors, it is meant to be used from the GL
+// thread only.
+class GpuMemory
+{
+public:
+    // return true if the resource was (or will be) released
+    using EvictionHandler = std::function<bool(unsigned int id, GpuResourceCategory category, size_t bytes)>;
+private:
+    struct Allocation
+    {
+        GpuResourceCategory Category;
+        size_t Bytes;
+        unsigned long long LastUse;
+        bool Live;
+    };
+
+    std::vector<Allocation> m_Allocations;    // indexed by id - 1
+    std::vector<unsigned int> m_FreeIDs;
+    GpuMemoryStats m_Stats;
+    unsigned long long m_Clock;
+    size_t m_Budget;
+    EvictionHandler m_EvictionHandler;
+    bool m_Evicting;
+
+    GpuMemory();
+public:
+    static GpuMemory& Get();
+
+    unsigned int Register(GpuResourceCategory category, size_t bytes);
+    void Unregister(unsigned int id);
+    // Evicts down to the budget. Owners call it once the id Register returned
+    // is stored, so the handler can already tell the new resource apart.
+    void EnforceBudget();
+
+    inline void Touch(unsigned int id)
+    {
+        if (id != 0)
+            m_Allocations[id - 1].LastUse = ++m_Clock;
+    }
+
+    // 0 disables the budget
+    void SetBudget(size_t bytes);
+    inline size_t GetBudget() const { return m_Budget; }
+    inline void SetEvictionHandler(EvictionHandler handler) { m_EvictionHandler = std::move(handler); }
+    inline const EvictionHandler& GetEvictionHandler() const { return m_EvictionHandler; }
+
+    size_t GetAllocationSize(unsigned int id) const;
+    inline const GpuMemoryStats& GetStats() const { return m_Stats; }
+    void PrintStats() const;
+
+    static const char* GetCategoryName(GpuResourceCategory category);
+};
@@ -0,0 +1,33 @@
+#include "ImageLoader.h"
+#include "MappedFile.h"
+#include "stb_image.h"
+
+#include <climits>
+
+namespace
+{
+    // set when Load fails before stb_image runs; stbi_failure_reason covers the rest
+    thread_local const char* s_FailureReason = nullptr;
+}
+
+unsigned char* ImageLoader::Load(const std::string &path, int* width, int* height, int* channels, int desiredChannels)
+{
+    s_FailureReason = nullptr;
+    MappedFile file(path, FileAccess::SEQUENTIAL);
+    if (!file.IsOpen())
+        return stbi_load(path.c_str(), width, height, channels, desiredChannels); // reports the open error
+    if (file.GetSize() > INT_MAX)
+    {
+        s_FailureReason = "file too large";
+        return nullptr;
+    }
+    return stbi_load_from_memory(file.GetData(), (int)file.GetSize(), width, height, channels, desiredChannels);
+}
+
+const char* ImageLoader::GetFailureReason()
+{
+    if (s_FailureReason)
+        return s_FailureReason;
+    const char* reason = stbi_failure_reason();
+    return reason ? reason : "unknown error";
+}
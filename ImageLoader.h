@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+
+// Decodes image files from a sequential MappedFile (an owned read() buffer for
+// pipes) instead of stbi_load's stdio path, which pulls big files through a
+// small buffer in thousands of reads. Honors stbi_set_flip_vertically_on_load;
+// results are freed with stbi_image_free.
+class ImageLoader
+{
+public:
+    static unsigned char* Load(const std::string& path, int* width, int* height, int* channels, int desiredChannels);
+    // why the calling thread's last Load returned null; never null itself
+    static const char* GetFailureReason();
+};
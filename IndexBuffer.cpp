@@ -1,4 +1,5 @@
 #include "IndexBuffer.h"
+#include "GpuMemory.h"
 
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
     : m_Count(count)
@@ -6,16 +7,44 @@ IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
     glGenBuffers(1, &m_RendererID);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW);
+    m_AllocationID = GpuMemory::Get().Register(GpuResourceCategory::INDEX_BUFFER, count * sizeof(unsigned int));
+    GpuMemory::Get().EnforceBudget();
 }
 
 IndexBuffer::~IndexBuffer()
 {
     glDeleteBuffers(1, &m_RendererID);
+    GpuMemory::Get().Unregister(m_AllocationID);
+}
+
+IndexBuffer::IndexBuffer(IndexBuffer&& other) noexcept
+    : m_RendererID(other.m_RendererID), m_Count(other.m_Count), m_AllocationID(other.m_AllocationID)
+{
+    other.m_RendererID = 0;
+    other.m_Count = 0;
+    other.m_AllocationID = 0;
+}
+
+IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        glDeleteBuffers(1, &m_RendererID);
+        GpuMemory::Get().Unregister(m_AllocationID);
+        m_RendererID = other.m_RendererID;
+        m_Count = other.m_Count;
+        m_AllocationID = other.m_AllocationID;
+        other.m_RendererID = 0;
+        other.m_Count = 0;
+        other.m_AllocationID = 0;
+    }
+    return *this;
 }
 
 void IndexBuffer::Bind() const
 {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+    GpuMemory::Get().Touch(m_AllocationID);
 }
 
 void IndexBuffer::Unbind() const
@@ -8,14 +8,23 @@ class IndexBuffer
 private:
     unsigned int m_RendererID;
     unsigned int m_Count;
+    unsigned int m_AllocationID;
 public:
     IndexBuffer(const unsigned int* data, unsigned int count);
     ~IndexBuffer();
 
+    IndexBuffer(const IndexBuffer&) = delete;
+    IndexBuffer& operator=(const IndexBuffer&) = delete;
+    IndexBuffer(IndexBuffer&& other) noexcept;
+    IndexBuffer& operator=(IndexBuffer&& other) noexcept;
+
     void Bind() const;
     void Unbind() const;
 
     inline unsigned int GetCount() const { return m_Count; }
+    inline unsigned int GetSize() const { return m_Count * sizeof(unsigned int); }
+    // GpuMemory id, as passed to its eviction handler
+    inline unsigned int GetAllocationID() const { return m_AllocationID; }
 };
 
 #endif
\ No newline at end of file
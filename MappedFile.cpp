@@ -0,0 +1,128 @@
+#include "MappedFile.h"
+
+#include <cerrno>
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile()
+    : m_Data(nullptr), m_Size(0), m_Mapped(false)
+{
+}
+
+MappedFile::MappedFile(const std::string &path, FileAccess access)
+    : m_Data(nullptr), m_Size(0), m_Mapped(false)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return;
+    }
+
+    if (S_ISREG(st.st_mode))
+    {
+        if (st.st_size > 0)
+        {
+            void* data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                if (access == FileAccess::SEQUENTIAL)
+                    madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+                m_Data = data;
+                m_Size = (size_t)st.st_size;
+                m_Mapped = true;
+            }
+            else
+            {
+                ReadAll(fd);
+            }
+        }
+    }
+    else
+    {
+        // pipes, FIFOs and character devices have no size to map
+        ReadAll(fd);
+    }
+    // the mapping keeps its own reference to the file
+    close(fd);
+}
+
+void MappedFile::ReadAll(int fd)
+{
+    size_t capacity = 64 * 1024;
+    size_t size = 0;
+    unsigned char* buffer = static_cast<unsigned char*>(std::malloc(capacity));
+    while (buffer)
+    {
+        if (size == capacity)
+        {
+            unsigned char* grown = static_cast<unsigned char*>(std::realloc(buffer, capacity * 2));
+            if (!grown)
+                break;
+            buffer = grown;
+            capacity *= 2;
+        }
+        ssize_t count = read(fd, buffer + size, capacity - size);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0)
+            break;
+        if (count == 0)
+        {
+            if (size == 0)
+                break;
+            m_Data = buffer;
+            m_Size = size;
+            return;
+        }
+        size += (size_t)count;
+    }
+    std::free(buffer);
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_Data(other.m_Data), m_Size(other.m_Size), m_Mapped(other.m_Mapped)
+{
+    other.m_Data = nullptr;
+    other.m_Size = 0;
+    other.m_Mapped = false;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        m_Data = other.m_Data;
+        m_Size = other.m_Size;
+        m_Mapped = other.m_Mapped;
+        other.m_Data = nullptr;
+        other.m_Size = 0;
+        other.m_Mapped = false;
+    }
+    return *this;
+}
+
+void MappedFile::Close()
+{
+    if (m_Mapped)
+        munmap(m_Data, m_Size);
+    else
+        std::free(m_Data);
+    m_Data = nullptr;
+    m_Size = 0;
+    m_Mapped = false;
+}
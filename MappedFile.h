@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+enum class FileAccess
+{
+    RANDOM = 0,     // default kernel readahead
+    SEQUENTIAL = 1  // MADV_SEQUENTIAL: aggressive readahead, pages dropped behind
+};
+
+// Read-only memory mapping of a whole file. The mapping is released when the
+// object is destroyed; empty or unreadable files leave it closed. Pipes and
+// other files that cannot be mapped are read into an owned buffer instead.
+class MappedFile
+{
+private:
+    void* m_Data;
+    size_t m_Size;
+    bool m_Mapped;
+
+    void ReadAll(int fd);
+public:
+    MappedFile();
+    explicit MappedFile(const std::string& path, FileAccess access = FileAccess::RANDOM);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    void Close();
+
+    inline bool IsOpen() const { return m_Data != nullptr; }
+    inline bool IsMapped() const { return m_Mapped; }
+    inline const unsigned char* GetData() const { return static_cast<const unsigned char*>(m_Data); }
+    inline size_t GetSize() const { return m_Size; }
+};
@@ -0,0 +1,141 @@
+// the glm/simd kernels are only declared when glm is allowed to use intrinsics.
+// Default (packed) glm types keep their layout and scalar code paths with it.
+#define GLM_FORCE_INTRINSICS
+#include "MatrixKernels.h"
+
+#include "glm/simd/matrix.h"
+
+namespace {
+
+void MultiplyScalar(const glm::mat4& a, const glm::mat4& b, glm::mat4& out)
+{
+    out = a * b;
+}
+
+void MultiplyVectorScalar(const glm::mat4& m, const glm::vec4& v, glm::vec4& out)
+{
+    out = m * v;
+}
+
+void InverseScalar(const glm::mat4& m, glm::mat4& out)
+{
+    out = glm::inverse(m);
+}
+
+void TransposeScalar(const glm::mat4& m, glm::mat4& out)
+{
+    out = glm::transpose(m);
+}
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+
+// glm::mat4 is only 4-byte aligned, so columns go through unaligned loads
+inline void LoadColumns(const glm::mat4& m, glm_vec4 columns[4])
+{
+    for (int i = 0; i < 4; i++)
+        columns[i] = _mm_loadu_ps(&m[i].x);
+}
+
+inline void StoreColumns(const glm_vec4 columns[4], glm::mat4& m)
+{
+    for (int i = 0; i < 4; i++)
+        _mm_storeu_ps(&m[i].x, columns[i]);
+}
+
+void MultiplySse(const glm::mat4& a, const glm::mat4& b, glm::mat4& out)
+{
+    glm_vec4 x[4], y[4], r[4];
+    LoadColumns(a, x);
+    LoadColumns(b, y);
+    glm_mat4_mul(x, y, r);
+    StoreColumns(r, out);
+}
+
+void MultiplyVectorSse(const glm::mat4& m, const glm::vec4& v, glm::vec4& out)
+{
+    glm_vec4 x[4];
+    LoadColumns(m, x);
+    _mm_storeu_ps(&out.x, glm_mat4_mul_vec4(x, _mm_loadu_ps(&v.x)));
+}
+
+void InverseSse(const glm::mat4& m, glm::mat4& out)
+{
+    glm_vec4 x[4], r[4];
+    LoadColumns(m, x);
+    glm_mat4_inverse(x, r);
+    StoreColumns(r, out);
+}
+
+void TransposeSse(const glm::mat4& m, glm::mat4& out)
+{
+    glm_vec4 x[4], r[4];
+    LoadColumns(m, x);
+    glm_mat4_transpose(x, r);
+    StoreColumns(r, out);
+}
+
+#endif
+
+#if (GLM_ARCH & GLM_ARCH_SSE2_BIT) && GLM_HAS_AVX_KERNELS
+
+// built for AVX+FMA like the kernels so they inline; only reached through the
+// table when CpuFeatures reports both
+#define AVX_TARGET __attribute__((target("avx,fma")))
+
+AVX_TARGET void MultiplyAvx(const glm::mat4& a, const glm::mat4& b, glm::mat4& out)
+{
+    glm_vec4 x[4], y[4], r[4];
+    LoadColumns(a, x);
+    LoadColumns(b, y);
+    glm_mat4_mul_avx(x, y, r);
+    StoreColumns(r, out);
+}
+
+AVX_TARGET void MultiplyVectorAvx(const glm::mat4& m, const glm::vec4& v, glm::vec4& out)
+{
+    glm_vec4 x[4];
+    LoadColumns(m, x);
+    _mm_storeu_ps(&out.x, glm_mat4_mul_vec4_avx(x, _mm_loadu_ps(&v.x)));
+}
+
+AVX_TARGET void InverseAvx(const glm::mat4& m, glm::mat4& out)
+{
+    glm_vec4 x[4], r[4];
+    LoadColumns(m, x);
+    glm_mat4_inverse_avx(x, r);
+    StoreColumns(r, out);
+}
+
+AVX_TARGET void TransposeAvx(const glm::mat4& m, glm::mat4& out)
+{
+    glm_vec4 x[4], r[4];
+    LoadColumns(m, x);
+    glm_mat4_transpose_avx(x, r);
+    StoreColumns(r, out);
+}
+
+#endif
+
+}
+
+MatrixKernels MatrixKernels::ForLevel(SimdLevel level)
+{
+    level = CpuFeatures::Get().Clamp(level);
+    MatrixKernels kernels = { SimdLevel::SCALAR, MultiplyScalar, MultiplyVectorScalar, InverseScalar, TransposeScalar };
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+    if (level >= SimdLevel::SSE)
+        kernels = { SimdLevel::SSE, MultiplySse, MultiplyVectorSse, InverseSse, TransposeSse };
+#endif
+#if (GLM_ARCH & GLM_ARCH_SSE2_BIT) && GLM_HAS_AVX_KERNELS
+    if (level >= SimdLevel::AVX)
+        kernels = { SimdLevel::AVX, MultiplyAvx, MultiplyVectorAvx, InverseAvx, TransposeAvx };
+#endif
+    return kernels;
+}
+
+const MatrixKernels& MatrixKernels::Get()
+{
+    static const MatrixKernels kernels = ForLevel(SimdLevel::AVX);
+    return kernels;
+}
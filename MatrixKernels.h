@@ -0,0 +1,23 @@
+#pragma once
+
+#include "CpuFeatures.h"
+#include "glm/glm.hpp"
+
+// mat4 operations behind function pointers so one binary runs the fastest
+// path the host supports: plain glm (scalar), the 128-bit glm/simd kernels,
+// or their 256-bit AVX/FMA versions. The SIMD paths round differently from
+// scalar glm in the last bits; inverse uses a different (block-wise) formula
+// at the AVX level.
+struct MatrixKernels
+{
+    SimdLevel Level;
+    void (*Multiply)(const glm::mat4& a, const glm::mat4& b, glm::mat4& out);
+    void (*MultiplyVector)(const glm::mat4& m, const glm::vec4& v, glm::vec4& out);
+    void (*Inverse)(const glm::mat4& m, glm::mat4& out);
+    void (*Transpose)(const glm::mat4& m, glm::mat4& out);
+
+    // the best level for this CPU, selected on first use
+    static const MatrixKernels& Get();
+    // a given level, capped to what the CPU supports
+    static MatrixKernels ForLevel(SimdLevel level);
+};
@@ -0,0 +1,286 @@
+#include "MineBitboard.h"
+#include "CpuFeatures.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MINE_BITBOARD_AVX2
+#endif
+
+namespace {
+
+// Each cell's count is the sum of eight shifted copies of the mine layer.
+// Summing the three rows first gives a 2-bit column sum s (above + self +
+// below) and a 2-bit p (above + below); the count is then s shifted from the
+// left + s shifted from the right + p, three 2-bit numbers added with a
+// full-adder network into four bit planes, 64 cells per word.
+struct CountPlanes
+{
+    uint64_t Bit0, Bit1, Bit2, Bit3;
+};
+
+inline void ColumnSum(uint64_t up, uint64_t mid, uint64_t down, uint64_t& s0, uint64_t& s1)
+{
+    uint64_t half = up ^ mid;
+    s0 = half ^ down;
+    s1 = (up & mid) | (half & down);
+}
+
+inline CountPlanes CountWord(const uint64_t* up, const uint64_t* mid, const uint64_t* down, size_t k)
+{
+    uint64_t s0, s1, s0Left, s1Left, s0Right, s1Right;
+    ColumnSum(up[k], mid[k], down[k], s0, s1);
+    ColumnSum(up[k - 1], mid[k - 1], down[k - 1], s0Left, s1Left);
+    ColumnSum(up[k + 1], mid[k + 1], down[k + 1], s0Right, s1Right);
+
+    // cell x sees column x - 1 (bit x - 1, or bit 63 of the word before) and x + 1
+    uint64_t l0 = (s0 << 1) | (s0Left >> 63);
+    uint64_t l1 = (s1 << 1) | (s1Left >> 63);
+    uint64_t r0 = (s0 >> 1) | (s0Right << 63);
+    uint64_t r1 = (s1 >> 1) | (s1Right << 63);
+    uint64_t p0 = up[k] ^ down[k];
+    uint64_t p1 = up[k] & down[k];
+
+    uint64_t t = l0 ^ r0;
+    uint64_t bit0 = t ^ p0;
+    uint64_t carry0 = (l0 & r0) | (t & p0);
+    // four weight-2 inputs: l1, r1, p1, carry0
+    uint64_t w = l1 ^ r1;
+    uint64_t v = w ^ p1;
+    uint64_t carryA = (l1 & r1) | (w & p1);
+    uint64_t carryB = v & carry0;
+
+    uint64_t safe = ~mid[k];
+    return { bit0 & safe, (v ^ carry0) & safe, (carryA ^ carryB) & safe, carryA & carryB & safe };
+}
+
+// byte j of Entries[v] is bit j of v
+struct SpreadTable
+{
+    uint64_t Entries[256];
+
+    SpreadTable()
+    {
+        for (int v = 0; v < 256; v++)
+        {
+            uint64_t entry = 0;
+            for (int j = 0; j < 8; j++)
+                if (v & (1 << j))
+                    entry |= (uint64_t)1 << (8 * j);
+            Entries[v] = entry;
+        }
+    }
+};
+
+const SpreadTable s_Spread;
+
+// one byte per cell from the four count planes of a word
+void ExpandScalar(const CountPlanes& planes, unsigned char* out, int cells)
+{
+    unsigned char bytes[64];
+    for (int j = 0; j < 8; j++)
+    {
+        int shift = 8 * j;
+        uint64_t eight = s_Spread.Entries[(planes.Bit0 >> shift) & 0xFF]
+            | s_Spread.Entries[(planes.Bit1 >> shift) & 0xFF] << 1
+            | s_Spread.Entries[(planes.Bit2 >> shift) & 0xFF] << 2
+            | s_Spread.Entries[(planes.Bit3 >> shift) & 0xFF] << 3;
+        // byte b of eight is cell 8 * j + b on a little-endian host
+        std::memcpy(bytes + 8 * j, &eight, 8);
+    }
+    std::memcpy(out, bytes, cells);
+}
+
+#ifdef MINE_BITBOARD_AVX2
+
+__attribute__((target("avx2")))
+inline void ColumnSumAvx2(__m256i up, __m256i mid, __m256i down, __m256i& s0, __m256i& s1)
+{
+    __m256i half = _mm256_xor_si256(up, mid);
+    s0 = _mm256_xor_si256(half, down);
+    s1 = _mm256_or_si256(_mm256_and_si256(up, mid), _mm256_and_si256(half, down));
+}
+
+__attribute__((target("avx2")))
+inline __m256i LoadWords(const uint64_t* words)
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words));
+}
+
+// 64 count bytes from one word of each plane: every byte of the word is
+// broadcast to eight lanes, tested against its bit and weighted by the plane
+__attribute__((target("avx2")))
+inline void ExpandAvx2(const uint64_t* planes, unsigned char* out)
+{
+    const __m256i lowBytes = _mm256_setr_epi8(
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+        2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i highBytes = _mm256_setr_epi8(
+        4, 4, 4, 4, 4, 4, 4, 4, 5, 5, 5, 5, 5, 5, 5, 5,
+        6, 6, 6, 6, 6, 6, 6, 6, 7, 7, 7, 7, 7, 7, 7, 7);
+    const __m256i bits = _mm256_set1_epi64x((long long)0x8040201008040201ULL);
+
+    __m256i low = _mm256_setzero_si256();
+    __m256i high = _mm256_setzero_si256();
+    for (int p = 0; p < 4; p++)
+    {
+        __m256i word = _mm256_set1_epi64x((long long)planes[p]);
+        __m256i weight = _mm256_set1_epi8((char)(1 << p));
+        __m256i l = _mm256_cmpeq_epi8(_mm256_and_si256(_mm256_shuffle_epi8(word, lowBytes), bits), bits);
+        __m256i h = _mm256_cmpeq_epi8(_mm256_and_si256(_mm256_shuffle_epi8(word, highBytes), bits), bits);
+        low = _mm256_or_si256(low, _mm256_and_si256(l, weight));
+        high = _mm256_or_si256(high, _mm256_and_si256(h, weight));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), low);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32), high);
+}
+
+#endif
+
+}
+
+MineBitboard::MineBitboard(int width, int height)
+    : m_Width(width), m_Height(height)
+{
+    m_WordsPerRow = ((size_t)width + 63) / 64;
+    // the AVX2 loop reads 4-word groups plus one word either side
+    m_Stride = (m_WordsPerRow + 3) / 4 * 4 + 2;
+    m_Words.assign((size_t)(height + 2) * m_Stride, 0);
+}
+
+void MineBitboard::Clear()
+{
+    std::fill(m_Words.begin(), m_Words.end(), 0);
+}
+
+void MineBitboard::ClearRows(int firstRow, int endRow)
+{
+    firstRow = std::max(firstRow, 0);
+    endRow = std::min(endRow, m_Height);
+    if (firstRow < endRow)
+        std::fill(GetRow(firstRow) - 1, GetRow(endRow) - 1, 0);
+}
+
+void MineBitboard::FillRows(int firstRow, int endRow)
+{
+    // bits past the width stay clear
+    uint64_t last = m_Width % 64 ? ((uint64_t)1 << (m_Width % 64)) - 1 : ~(uint64_t)0;
+    for (int y = std::max(firstRow, 0); y < std::min(endRow, m_Height); y++)
+    {
+        uint64_t* row = GetRow(y);
+        std::fill(row, row + m_WordsPerRow - 1, ~(uint64_t)0);
+        row[m_WordsPerRow - 1] = last;
+    }
+}
+
+size_t MineBitboard::CountMines() const
+{
+    size_t mines = 0;
+    for (uint64_t word : m_Words)
+        mines += std::bitset<64>(word).count();
+    return mines;
+}
+
+void MineBitboard::CountNeighbors(unsigned char* counts, size_t stride, int firstRow, int endRow, bool simd) const
+{
+    firstRow = std::max(firstRow, 0);
+    endRow = std::min(endRow, m_Height);
+    if (firstRow >= endRow)
+        return;
+#ifdef MINE_BITBOARD_AVX2
+    if (simd && CpuFeatures::Get().AVX2)
+    {
+        CountRowsAvx2(firstRow, endRow, counts, stride);
+        return;
+    }
+#endif
+    CountRowsScalar(firstRow, endRow, counts, stride);
+}
+
+void MineBitboard::CountRowsScalar(int firstRow, int endRow, unsigned char* counts, size_t stride) const
+{
+    for (int y = firstRow; y < endRow; y++)
+    {
+        const uint64_t* up = GetRow(y - 1);
+        const uint64_t* mid = GetRow(y);
+        const uint64_t* down = GetRow(y + 1);
+        unsigned char* out = counts + (size_t)y * stride;
+        for (size_t k = 0; k < m_WordsPerRow; k++)
+        {
+            int cells = std::min(64, m_Width - (int)(k * 64));
+            ExpandScalar(CountWord(up, mid, down, k), out + k * 64, cells);
+        }
+    }
+}
+
+#ifdef MINE_BITBOARD_AVX2
+
+__attribute__((target("avx2")))
+void MineBitboard::CountRowsAvx2(int firstRow, int endRow, unsigned char* counts, size_t stride) const
+{
+    alignas(32) uint64_t planes[4][4];
+    for (int y = firstRow; y < endRow; y++)
+    {
+        const uint64_t* up = GetRow(y - 1);
+        const uint64_t* mid = GetRow(y);
+        const uint64_t* down = GetRow(y + 1);
+        unsigned char* out = counts + (size_t)y * stride;
+        for (size_t k = 0; k < m_WordsPerRow; k += 4)
+        {
+            __m256i u = LoadWords(up + k), c = LoadWords(mid + k), d = LoadWords(down + k);
+            __m256i s0, s1, s0Left, s1Left, s0Right, s1Right;
+            ColumnSumAvx2(u, c, d, s0, s1);
+            ColumnSumAvx2(LoadWords(up + k - 1), LoadWords(mid + k - 1), LoadWords(down + k - 1), s0Left, s1Left);
+            ColumnSumAvx2(LoadWords(up + k + 1), LoadWords(mid + k + 1), LoadWords(down + k + 1), s0Right, s1Right);
+
+            __m256i l0 = _mm256_or_si256(_mm256_slli_epi64(s0, 1), _mm256_srli_epi64(s0Left, 63));
+            __m256i l1 = _mm256_or_si256(_mm256_slli_epi64(s1, 1), _mm256_srli_epi64(s1Left, 63));
+            __m256i r0 = _mm256_or_si256(_mm256_srli_epi64(s0, 1), _mm256_slli_epi64(s0Right, 63));
+            __m256i r1 = _mm256_or_si256(_mm256_srli_epi64(s1, 1), _mm256_slli_epi64(s1Right, 63));
+            __m256i p0 = _mm256_xor_si256(u, d);
+            __m256i p1 = _mm256_and_si256(u, d);
+
+            __m256i t = _mm256_xor_si256(l0, r0);
+            __m256i bit0 = _mm256_xor_si256(t, p0);
+            __m256i carry0 = _mm256_or_si256(_mm256_and_si256(l0, r0), _mm256_and_si256(t, p0));
+            __m256i w = _mm256_xor_si256(l1, r1);
+            __m256i v = _mm256_xor_si256(w, p1);
+            __m256i carryA = _mm256_or_si256(_mm256_and_si256(l1, r1), _mm256_and_si256(w, p1));
+            __m256i carryB = _mm256_and_si256(v, carry0);
+
+            // andnot clears the planes of mine cells
+            _mm256_store_si256(reinterpret_cast<__m256i*>(planes[0]), _mm256_andnot_si256(c, bit0));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(planes[1]), _mm256_andnot_si256(c, _mm256_xor_si256(v, carry0)));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(planes[2]), _mm256_andnot_si256(c, _mm256_xor_si256(carryA, carryB)));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(planes[3]), _mm256_andnot_si256(c, _mm256_and_si256(carryA, carryB)));
+
+            for (size_t j = 0; j < 4 && k + j < m_WordsPerRow; j++)
+            {
+                uint64_t word[4] = { planes[0][j], planes[1][j], planes[2][j], planes[3][j] };
+                int first = (int)((k + j) * 64);
+                if (first + 64 <= m_Width)
+                {
+                    ExpandAvx2(word, out + first);
+                }
+                else
+                {
+                    unsigned char partial[64];
+                    ExpandAvx2(word, partial);
+                    std::memcpy(out + first, partial, m_Width - first);
+                }
+            }
+        }
+    }
+}
+
+#else
+
+void MineBitboard::CountRowsAvx2(int firstRow, int endRow, unsigned char* counts, size_t stride) const
+{
+    CountRowsScalar(firstRow, endRow, counts, stride);
+}
+
+#endif
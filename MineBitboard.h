@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Mine layer of a board as packed bitboards: one bit per cell, bit x % 64 of
+// word x / 64 in each row. Every row carries a zero word on both sides (and
+// is padded to whole 4-word groups), and there is a zero row above and below
+// the board, so the neighbor count can read rows y - 1 .. y + 1 and words
+// k - 1 .. k + 1 anywhere without bounds checks. Bits past the width are
+// always zero.
+class MineBitboard
+{
+private:
+    int m_Width;
+    int m_Height;
+    size_t m_WordsPerRow;   // words holding cells
+    size_t m_Stride;        // words per padded row
+    std::vector<uint64_t> m_Words;
+
+    void CountRowsScalar(int firstRow, int endRow, unsigned char* counts, size_t stride) const;
+    void CountRowsAvx2(int firstRow, int endRow, unsigned char* counts, size_t stride) const;
+public:
+    MineBitboard(int width, int height);
+
+    inline int GetWidth() const { return m_Width; }
+    inline int GetHeight() const { return m_Height; }
+    inline size_t GetWordsPerRow() const { return m_WordsPerRow; }
+    // words from one row to the next
+    inline size_t GetStride() const { return m_Stride; }
+
+    // first cell word of row y; rows -1 and height are the zero halo rows
+    inline uint64_t* GetRow(int y) { return m_Words.data() + (size_t)(y + 1) * m_Stride + 1; }
+    inline const uint64_t* GetRow(int y) const { return m_Words.data() + (size_t)(y + 1) * m_Stride + 1; }
+
+    inline bool Get(int x, int y) const { return (GetRow(y)[x >> 6] >> (x & 63)) & 1; }
+    inline void Set(int x, int y, bool mine)
+    {
+        uint64_t bit = (uint64_t)1 << (x & 63);
+        uint64_t& word = GetRow(y)[x >> 6];
+        word = mine ? word | bit : word & ~bit;
+    }
+
+    void Clear();
+    // zeroes rows [firstRow, endRow); bands of rows can be cleared concurrently
+    void ClearRows(int firstRow, int endRow);
+    // puts a mine on every cell of rows [firstRow, endRow)
+    void FillRows(int firstRow, int endRow);
+    size_t CountMines() const;
+
+    // Writes the number of adjacent mines of every cell in rows
+    // [firstRow, endRow) to counts[y * stride + x] (counts points at row 0).
+    // Mine cells get 0. Only the rows firstRow - 1 .. endRow are read, so
+    // bands of rows can be counted concurrently. Uses AVX2 when the CPU has
+    // it unless simd is false.
+    void CountNeighbors(unsigned char* counts, size_t stride, int firstRow, int endRow, bool simd = true) const;
+    inline void CountNeighbors(unsigned char* counts, size_t stride, bool simd = true) const
+    {
+        CountNeighbors(counts, stride, 0, m_Height, simd);
+    }
+};
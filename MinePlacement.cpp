@@ -0,0 +1,129 @@
+#include "MinePlacement.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+double LogChoose(double n, double k)
+{
+    return std::lgamma(n + 1.0) - std::lgamma(k + 1.0) - std::lgamma(n - k + 1.0);
+}
+
+// How many of `mines` mines among `total` cells land in the first `cells`
+// of them. Inverts the distribution starting at its mode and walking
+// outwards on both sides, using the ratio between neighboring terms, so the
+// cost is about one standard deviation of steps.
+size_t SampleHypergeometric(Xoshiro256& rng, size_t total, size_t mines, size_t cells)
+{
+    if (cells == 0 || mines == 0)
+        return 0;
+    if (cells >= total)
+        return mines;
+
+    double n = (double)cells, k = (double)mines, N = (double)total;
+    size_t low = mines + cells > total ? mines + cells - total : 0;
+    size_t high = std::min(cells, mines);
+    size_t mode = (size_t)((n + 1.0) * (k + 1.0) / (N + 2.0));
+    mode = std::min(std::max(mode, low), high);
+
+    // p(x + 1) / p(x)
+    auto ratio = [&](double x) { return (k - x) * (n - x) / ((x + 1.0) * (N - k - n + x + 1.0)); };
+
+    double pMode = std::exp(LogChoose(k, (double)mode) + LogChoose(N - k, n - (double)mode) - LogChoose(N, n));
+    double u = rng.NextDouble() - pMode;
+    if (u <= 0.0)
+        return mode;
+
+    size_t up = mode, down = mode;
+    double pUp = pMode, pDown = pMode;
+    while (up < high || down > low)
+    {
+        if (up < high)
+        {
+            pUp *= ratio((double)up);
+            up++;
+            u -= pUp;
+            if (u <= 0.0)
+                return up;
+        }
+        if (down > low)
+        {
+            down--;
+            pDown /= ratio((double)down);
+            u -= pDown;
+            if (u <= 0.0)
+                return down;
+        }
+    }
+    // rounding left u just above the total mass
+    return mode;
+}
+
+}
+
+std::vector<MineBand> MinePlacement::SplitBands(int width, int height, size_t mines, uint64_t seed)
+{
+    Xoshiro256 rng = Xoshiro256::ForStream(seed, 0);
+    std::vector<MineBand> bands;
+    bands.reserve((height + s_BandRows - 1) / s_BandRows);
+
+    size_t cellsLeft = (size_t)width * height;
+    size_t minesLeft = std::min(mines, cellsLeft);
+    for (int first = 0; first < height; first += s_BandRows)
+    {
+        int end = std::min(first + s_BandRows, height);
+        size_t cells = (size_t)width * (end - first);
+        size_t share = SampleHypergeometric(rng, cellsLeft, minesLeft, cells);
+        bands.push_back({ first, end, share });
+        cellsLeft -= cells;
+        minesLeft -= share;
+    }
+    return bands;
+}
+
+void MinePlacement::PlaceBand(MineBitboard& bitboard, const MineBand& band, uint64_t seed, size_t bandIndex)
+{
+    bitboard.ClearRows(band.FirstRow, band.EndRow);
+
+    int width = bitboard.GetWidth();
+    uint64_t cells = (uint64_t)width * (uint64_t)(band.EndRow - band.FirstRow);
+    uint64_t mines = std::min<uint64_t>(band.Mines, cells);
+    bool invert = mines * 2 > cells;
+    if (invert)
+        bitboard.FillRows(band.FirstRow, band.EndRow);
+
+    // Floyd: for each j in [cells - picks, cells) take a random t <= j, or j
+    // itself if t is already taken (j cannot be, it was out of range so far)
+    Xoshiro256 rng = Xoshiro256::ForStream(seed, bandIndex + 1);
+    uint64_t picks = invert ? cells - mines : mines;
+    uint64_t first = cells - picks;
+    uint64_t* rows = bitboard.GetRow(band.FirstRow);
+    size_t stride = bitboard.GetStride();
+    uint64_t untaken = invert ? 1 : 0;
+    // j's cell is tracked incrementally, so only t needs a division, and a
+    // 32-bit one whenever the band allows
+    bool narrow = cells <= UINT32_MAX;
+    uint64_t jx = first % width;
+    uint64_t jy = first / width;
+    for (uint64_t j = first; j < cells; j++)
+    {
+        uint64_t t = rng.NextBelow(j + 1);
+        uint64_t ty = narrow ? (uint32_t)t / (uint32_t)width : t / width;
+        uint64_t tx = t - ty * width;
+        uint64_t* word = rows + ty * stride + (tx >> 6);
+        // select rather than branch, collisions are common near full density;
+        // the chosen cell is untaken, so flipping its bit takes it
+        bool taken = ((*word >> (tx & 63)) & 1) != untaken;
+        uint64_t x = taken ? jx : tx;
+        word = taken ? rows + jy * stride + (jx >> 6) : word;
+        *word ^= (uint64_t)1 << (x & 63);
+        if (++jx == (uint64_t)width)
+        {
+            jx = 0;
+            jy++;
+        }
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "MineBitboard.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// rows [FirstRow, EndRow) of a board and how many mines they receive
+struct MineBand
+{
+    int FirstRow;
+    int EndRow;
+    size_t Mines;
+};
+
+// Mine placement in horizontal bands of s_BandRows rows, so that bands can be
+// filled on different threads. Randomness comes from xoshiro256** streams
+// keyed by the seed and a counter: stream 0 splits the mines over the bands
+// and stream i + 1 places band i, so bands can run in any order. The split
+// into bands only depends on the board size, never on the thread count, so a
+// seed always yields the same board.
+class MinePlacement
+{
+public:
+    static const int s_BandRows = 64;
+
+    // Shares mines out over the bands. Each band's share is drawn from the
+    // hypergeometric distribution of the cells left after the bands before
+    // it, which makes uniform placement within every band uniform over the
+    // whole board.
+    static std::vector<MineBand> SplitBands(int width, int height, size_t mines, uint64_t seed);
+
+    // Clears the band's rows and places its mines uniformly within them with
+    // Floyd's sampling: one random draw per mine and no retries, at any
+    // density. Past half density the band is filled and the empty cells are
+    // picked instead.
+    static void PlaceBand(MineBitboard& bitboard, const MineBand& band, uint64_t seed, size_t bandIndex);
+};
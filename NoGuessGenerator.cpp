@@ -0,0 +1,118 @@
+#include "NoGuessGenerator.h"
+
+#include "Board.h"
+#include "Random.h"
+#include "Solver.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+
+void NoGuessGenerator::ClearStart(Board& board, int startX, int startY, uint64_t candidateSeed)
+{
+    const uint64_t cells = board.GetCellCount();
+    int firstX = startX - 1, lastX = startX + 1, firstY = startY - 1, lastY = startY + 1;
+    uint64_t blockCells = 0;
+    for (int y = firstY; y <= lastY; y++)
+        for (int x = firstX; x <= lastX; x++)
+            blockCells += board.Contains(x, y);
+    if ((uint64_t)board.GetMineCount() > cells - blockCells)
+    {
+        firstX = lastX = startX;
+        firstY = lastY = startY;
+        if ((uint64_t)board.GetMineCount() == cells)
+            return;
+    }
+
+    // Every move leaves at least as many free cells outside the block as
+    // mines still in it, so the rejection loop always finds one. Placement
+    // streams are numbered from 0 up; the last stream is never one of them.
+    Xoshiro256 random = Xoshiro256::ForStream(candidateSeed, ~(uint64_t)0);
+    for (int y = firstY; y <= lastY; y++)
+    {
+        for (int x = firstX; x <= lastX; x++)
+        {
+            if (!board.Contains(x, y) || !board.IsMine(x, y))
+                continue;
+            int toX, toY;
+            do
+            {
+                uint64_t cell = random.NextBelow(cells);
+                toX = (int)(cell % (uint64_t)board.GetWidth());
+                toY = (int)(cell / (uint64_t)board.GetWidth());
+            }
+            while (board.IsMine(toX, toY) || (toX >= firstX && toX <= lastX && toY >= firstY && toY <= lastY));
+            board.MoveMine(x, y, toX, toY);
+        }
+    }
+}
+
+void NoGuessGenerator::BuildCandidate(Board& board, uint64_t seed, uint64_t candidate, int startX, int startY)
+{
+    uint64_t candidateSeed = SplitMix64::At(seed, candidate);
+    board.Generate(candidateSeed);
+    ClearStart(board, startX, startY, candidateSeed);
+}
+
+bool NoGuessGenerator::IsSolvable(Board& board, int startX, int startY)
+{
+    Solver solver(board);
+    solver.Reveal(startX, startY);
+    return solver.Play();
+}
+
+NoGuessResult NoGuessGenerator::Generate(Board& board, uint64_t seed, int startX, int startY, size_t maxCandidates, ThreadPool* pool)
+{
+    NoGuessResult result = {};
+    if (!board.Contains(startX, startY))
+        return result;
+
+    std::atomic<uint64_t> next(0);
+    std::atomic<uint64_t> best(maxCandidates);
+    std::atomic<size_t> tested(0);
+    std::atomic<size_t> accepted(0);
+    const int width = board.GetWidth(), height = board.GetHeight(), mines = board.GetMineCount();
+
+    auto search = [&]()
+    {
+        Board candidate(width, height, mines);
+        for (;;)
+        {
+            uint64_t index = next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= best.load(std::memory_order_relaxed))
+                return;
+            BuildCandidate(candidate, seed, index, startX, startY);
+            bool solvable = IsSolvable(candidate, startX, startY);
+            tested.fetch_add(1, std::memory_order_relaxed);
+            if (!solvable)
+                continue;
+            accepted.fetch_add(1, std::memory_order_relaxed);
+            // every later index is either handed out after this one or
+            // already running, so lowering best is all it takes to stop
+            uint64_t current = best.load(std::memory_order_relaxed);
+            while (index < current && !best.compare_exchange_weak(current, index, std::memory_order_relaxed))
+            {
+            }
+            return;
+        }
+    };
+
+    if (pool && pool->GetThreadCount() > 1)
+    {
+        for (unsigned int i = 0; i < pool->GetThreadCount(); i++)
+            pool->Submit(search);
+        pool->Wait();
+    }
+    else
+        search();
+
+    result.Tested = tested.load();
+    result.Accepted = accepted.load();
+    result.Found = best.load() < maxCandidates;
+    if (result.Found)
+    {
+        result.Candidate = best.load();
+        result.Seed = SplitMix64::At(seed, result.Candidate);
+        BuildCandidate(board, seed, result.Candidate, startX, startY);
+    }
+    return result;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class Board;
+class ThreadPool;
+
+struct NoGuessResult
+{
+    bool Found;
+    uint64_t Candidate;     // index of the accepted candidate
+    uint64_t Seed;          // its Board::Generate seed
+    size_t Tested;          // candidates played to the end, accepted or not
+    size_t Accepted;
+};
+
+// Boards that can be cleared from a given first click without guessing.
+// Candidate i of a seed is the board Generate(SplitMix64::At(seed, i)) with
+// the mines of the 3x3 block around the first click moved to random free
+// cells elsewhere, so the click opens up; it is accepted when the Solver,
+// given only that click, plays it to the end.
+//
+// Candidates are tested concurrently, one Board per pool thread, each thread
+// taking the next index from a shared counter. The search stops at the first
+// success, but the result is the lowest accepted index, not whichever thread
+// finished first: indices above an accepted one are abandoned and those
+// below it still run to the end. A seed therefore always gives the same
+// board, whatever the thread count.
+class NoGuessGenerator
+{
+private:
+    // moves the mines off the start block, or off the start cell when the
+    // rest of the board has no room for the block's mines
+    static void ClearStart(Board& board, int startX, int startY, uint64_t candidateSeed);
+public:
+    // candidate `candidate` of `seed`, all hidden
+    static void BuildCandidate(Board& board, uint64_t seed, uint64_t candidate, int startX, int startY);
+
+    // Plays the board from (startX, startY) with the Solver and returns true
+    // if it ends up cleared. Leaves the board played.
+    static bool IsSolvable(Board& board, int startX, int startY);
+
+    // Tests candidates 0, 1, ... of the seed, up to maxCandidates, on the
+    // pool's threads when one is given (not from one of its own tasks), and
+    // leaves the accepted one in board, all hidden. When none is accepted
+    // the board is left as it was.
+    static NoGuessResult Generate(Board& board, uint64_t seed, int startX, int startY, size_t maxCandidates, ThreadPool* pool = nullptr);
+};
@@ -0,0 +1,67 @@
+#include "PixelUnpackBuffer.h"
+#include "GpuMemory.h"
+
+PixelUnpackBuffer::PixelUnpackBuffer(unsigned int size)
+    : m_Size(size)
+{
+    glGenBuffers(1, &m_RendererID);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_RendererID);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    m_AllocationID = GpuMemory::Get().Register(GpuResourceCategory::PIXEL_BUFFER, size);
+    GpuMemory::Get().EnforceBudget();
+}
+
+PixelUnpackBuffer::~PixelUnpackBuffer()
+{
+    glDeleteBuffers(1, &m_RendererID);
+    GpuMemory::Get().Unregister(m_AllocationID);
+}
+
+PixelUnpackBuffer::PixelUnpackBuffer(PixelUnpackBuffer&& other) noexcept
+    : m_RendererID(other.m_RendererID), m_Size(other.m_Size), m_AllocationID(other.m_AllocationID)
+{
+    other.m_RendererID = 0;
+    other.m_Size = 0;
+    other.m_AllocationID = 0;
+}
+
+PixelUnpackBuffer& PixelUnpackBuffer::operator=(PixelUnpackBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        glDeleteBuffers(1, &m_RendererID);
+        GpuMemory::Get().Unregister(m_AllocationID);
+        m_RendererID = other.m_RendererID;
+        m_Size = other.m_Size;
+        m_AllocationID = other.m_AllocationID;
+        other.m_RendererID = 0;
+        other.m_Size = 0;
+        other.m_AllocationID = 0;
+    }
+    return *this;
+}
+
+void* PixelUnpackBuffer::Map()
+{
+    Bind();
+    return glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, m_Size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+}
+
+bool PixelUnpackBuffer::Unmap()
+{
+    Bind();
+    bool ok = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE;
+    Unbind();
+    return ok;
+}
+
+void PixelUnpackBuffer::Bind() const
+{
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_RendererID);
+}
+
+void PixelUnpackBuffer::Unbind() const
+{
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
@@ -0,0 +1,35 @@
+#ifndef PIXEL_UNPACK_BUFFER_H
+#define PIXEL_UNPACK_BUFFER_H
+
+#include "glad/glad.h"
+
+// Staging buffer bound to GL_PIXEL_UNPACK_BUFFER for texture uploads. Map()
+// orphans the previous contents so the CPU never waits on an upload still
+// reading from it.
+class PixelUnpackBuffer
+{
+    private:
+        unsigned int m_RendererID;
+        unsigned int m_Size;
+        unsigned int m_AllocationID;
+    public:
+        PixelUnpackBuffer(unsigned int size);
+        ~PixelUnpackBuffer();
+
+        PixelUnpackBuffer(const PixelUnpackBuffer&) = delete;
+        PixelUnpackBuffer& operator=(const PixelUnpackBuffer&) = delete;
+        PixelUnpackBuffer(PixelUnpackBuffer&& other) noexcept;
+        PixelUnpackBuffer& operator=(PixelUnpackBuffer&& other) noexcept;
+
+        void* Map();
+        bool Unmap();
+
+        void Bind() const;
+        void Unbind() const;
+
+        inline unsigned int GetSize() const { return m_Size; }
+        // GpuMemory id, as passed to its eviction handler
+        inline unsigned int GetAllocationID() const { return m_AllocationID; }
+};
+
+#endif
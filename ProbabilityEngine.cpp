@@ -0,0 +1,807 @@
+#include "ProbabilityEngine.h"
+#include "Board.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <numeric>
+#include <string>
+
+namespace {
+
+inline CellState StateOf(unsigned char cell)
+{
+    return (CellState)((cell & Board::STATE_MASK) >> Board::STATE_SHIFT);
+}
+
+// hidden to the engine: flags are not trusted, so a flagged cell is hidden
+inline bool IsHidden(unsigned char cell)
+{
+    CellState state = StateOf(cell);
+    return state == CellState::HIDDEN || state == CellState::FLAGGED;
+}
+
+// a revealed count; border cells read as revealed but carry BORDER_BIT
+inline bool IsCount(unsigned char cell)
+{
+    return !(cell & Board::BORDER_BIT) && StateOf(cell) == CellState::REVEALED;
+}
+
+inline bool IsExplodedMine(unsigned char cell)
+{
+    return StateOf(cell) == CellState::MEME;
+}
+
+const uint64_t s_ByteOnes = 0x0101010101010101ULL;
+const uint64_t s_HighBits = 0x8080808080808080ULL;
+
+inline uint64_t Load(const unsigned char* bytes)
+{
+    uint64_t word;
+    std::memcpy(&word, bytes, 8);
+    return word;
+}
+
+// 0x80 in every byte that is not 0, exact (no borrow between bytes)
+inline uint64_t NonZeroBytes(uint64_t word)
+{
+    return (((word & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | word) & s_HighBits;
+}
+
+// 0x80 in the bytes of a word that are hidden (state bits 00 or 11), that
+// are revealed counts (state 01, no border bit) and that are exploded mines
+inline uint64_t HiddenBytes(uint64_t word)
+{
+    return ~NonZeroBytes((word ^ (word >> 1)) & (s_ByteOnes * 0x20)) & s_HighBits;
+}
+
+inline uint64_t CountBytes(uint64_t word)
+{
+    return ~NonZeroBytes((word & (s_ByteOnes * 0xE0)) ^ (s_ByteOnes * 0x20)) & s_HighBits;
+}
+
+inline uint64_t ExplodedBytes(uint64_t word)
+{
+    return ~NonZeroBytes((word & (s_ByteOnes * 0xE0)) ^ (s_ByteOnes * 0x40)) & s_HighBits;
+}
+
+inline int LowestBit(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int bit = 0;
+    while (!(word & 1))
+    {
+        word >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+inline int PopCount(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    int count = 0;
+    for (; word; word &= word - 1)
+        count++;
+    return count;
+#endif
+}
+
+// Counts of assignments by number of mines: Values[m] have Offset + m
+// mines. Every layer of the dynamic program is rescaled as a whole, so only
+// ratios within a layer are meaningful.
+struct MineCounts
+{
+    int Offset = 0;
+    std::vector<double> Values;
+
+    inline bool IsEmpty() const { return Values.empty(); }
+
+    // adds other with shift more mines
+    void Add(const MineCounts& other, int shift)
+    {
+        if (other.IsEmpty())
+            return;
+        int first = other.Offset + shift;
+        if (IsEmpty())
+        {
+            Offset = first;
+            Values = other.Values;
+            return;
+        }
+        int last = std::max(Offset + (int)Values.size(), first + (int)other.Values.size());
+        if (first < Offset)
+        {
+            Values.insert(Values.begin(), (size_t)(Offset - first), 0.0);
+            Offset = first;
+        }
+        Values.resize((size_t)(last - Offset), 0.0);
+        for (size_t i = 0; i < other.Values.size(); i++)
+            Values[(size_t)(first - Offset) + i] += other.Values[i];
+    }
+
+    void Scale(double factor)
+    {
+        for (double& value : Values)
+            value *= factor;
+    }
+
+    double Max() const
+    {
+        double max = 0.0;
+        for (double value : Values)
+            max = std::max(max, value);
+        return max;
+    }
+};
+
+// adds a * b, shifted by shift more mines, to dense counts indexed by mines
+void AddProduct(std::vector<double>& into, const MineCounts& a, const MineCounts& b, int shift)
+{
+    for (size_t i = 0; i < a.Values.size(); i++)
+    {
+        if (a.Values[i] == 0.0)
+            continue;
+        double* row = &into[(size_t)(a.Offset + b.Offset + shift) + i];
+        for (size_t j = 0; j < b.Values.size(); j++)
+            row[j] += a.Values[i] * b.Values[j];
+    }
+}
+
+// one layer of the dynamic program: the states reached before a cell
+struct Layer
+{
+    std::unordered_map<std::string, int> Index;
+    std::vector<std::string> Keys;
+    std::vector<MineCounts> Forward;    // assignments of the cells before, per state
+    std::vector<MineCounts> Backward;   // assignments of the cells from here on
+    std::vector<int> Next[2];           // state after the cell is safe / a mine, -1 if none
+
+    int Find(const std::string& key)
+    {
+        auto found = Index.find(key);
+        if (found != Index.end())
+            return found->second;
+        int state = (int)Keys.size();
+        Index.emplace(key, state);
+        Keys.push_back(key);
+        Forward.emplace_back();
+        return state;
+    }
+
+    void Normalize(std::vector<MineCounts>& counts)
+    {
+        double max = 0.0;
+        for (const MineCounts& count : counts)
+            max = std::max(max, count.Max());
+        if (max > 0.0)
+            for (MineCounts& count : counts)
+                count.Scale(1.0 / max);
+    }
+};
+
+// the at most 8 cells of a count, or counts of a cell
+struct Links
+{
+    int Items[8];
+    int Size = 0;
+
+    inline void Push(int item) { Items[Size++] = item; }
+    inline const int* begin() const { return Items; }
+    inline const int* end() const { return Items + Size; }
+};
+
+// how a count constraint is updated by assigning one cell
+struct Touch
+{
+    int FromSlot;   // position in the state before, -1 if the constraint opens here
+    int ToSlot;     // position in the state after, -1 if it closes here
+    int Mines;      // mines owed when it opens
+    int After;      // its cells after this one
+    bool Contains;
+};
+
+// cells in breadth-first order from a cell far from the start, which keeps
+// the number of counts open at any cell low on long, thin components
+std::vector<int> CountingOrder(size_t cellCount, const std::vector<std::vector<int>>& cellConstraints,
+                               const std::vector<std::vector<int>>& constraintCells)
+{
+    std::vector<int> order;
+    std::vector<char> seen(cellCount);
+    auto walk = [&](int root)
+    {
+        order.clear();
+        std::fill(seen.begin(), seen.end(), 0);
+        order.push_back(root);
+        seen[(size_t)root] = 1;
+        for (size_t i = 0; i < order.size(); i++)
+            for (int constraint : cellConstraints[(size_t)order[i]])
+                for (int cell : constraintCells[(size_t)constraint])
+                    if (!seen[(size_t)cell])
+                    {
+                        seen[(size_t)cell] = 1;
+                        order.push_back(cell);
+                    }
+    };
+    walk(0);
+    walk(order.back());
+    return order;
+}
+
+// log C(n, k), 0 <= k <= n
+double LogChoose(int n, int k)
+{
+    return std::lgamma((double)n + 1.0) - std::lgamma((double)k + 1.0) - std::lgamma((double)(n - k) + 1.0);
+}
+
+// result[x] = sum over t of weights[t] * values[x + t], normalized
+void ApplyWeights(std::vector<double>& values, const std::vector<double>& weights, std::vector<double>& scratch)
+{
+    scratch.assign(values.size(), 0.0);
+    for (size_t x = 0; x < values.size(); x++)
+    {
+        double sum = 0.0;
+        size_t count = std::min(weights.size(), values.size() - x);
+        for (size_t t = 0; t < count; t++)
+            sum += weights[t] * values[x + t];
+        scratch[x] = sum;
+    }
+    double max = *std::max_element(scratch.begin(), scratch.end());
+    if (max > 0.0)
+        for (double& value : scratch)
+            value /= max;
+    values.swap(scratch);
+}
+
+// into = into * weights, normalized
+void Convolve(std::vector<double>& into, const std::vector<double>& weights, std::vector<double>& scratch)
+{
+    scratch.assign(into.size() + weights.size() - 1, 0.0);
+    for (size_t i = 0; i < into.size(); i++)
+        for (size_t t = 0; t < weights.size(); t++)
+            scratch[i + t] += into[i] * weights[t];
+    double max = *std::max_element(scratch.begin(), scratch.end());
+    if (max > 0.0)
+        for (double& value : scratch)
+            value /= max;
+    into.swap(scratch);
+}
+
+} // namespace
+
+size_t ProbabilityEngine::KeyHash::operator()(const std::vector<uint32_t>& key) const
+{
+    uint64_t hash = key.size();
+    for (uint32_t word : key)
+        hash = SplitMix64::Mix(hash ^ word) + 0x9E3779B97F4A7C15ULL;
+    return (size_t)hash;
+}
+
+ProbabilityEngine::ProbabilityEngine(const Board& board)
+    : m_Board(board), m_Width(board.GetWidth()), m_Height(board.GetHeight()), m_Stride(board.GetStride()),
+      m_Probabilities(board.GetStride() * (size_t)board.GetHeight(), 0.0f), m_Stamp(board.GetStride() * (size_t)board.GetHeight(), 0),
+      m_LocalIndex(board.GetStride() * (size_t)board.GetHeight(), 0),
+      m_Epoch(0), m_InteriorProbability(0.0f), m_RecountedCount(0)
+{
+}
+
+void ProbabilityEngine::CollectRegion(uint32_t start, std::vector<uint32_t>& cells, std::vector<uint32_t>& counts)
+{
+    const unsigned char* origin = m_Board.GetCellData();
+    const ptrdiff_t stride = (ptrdiff_t)m_Stride;
+    const ptrdiff_t neighbors[8] = { -stride - 1, -stride, -stride + 1, -1, 1, stride - 1, stride, stride + 1 };
+
+    cells.clear();
+    counts.clear();
+    cells.push_back(start);
+    m_Stamp[start] = m_Epoch;
+    for (size_t i = 0; i < cells.size(); i++)
+    {
+        for (ptrdiff_t offset : neighbors)
+        {
+            ptrdiff_t count = (ptrdiff_t)cells[i] + offset;
+            if (!IsCount(origin[count]) || m_Stamp[(size_t)count] == m_Epoch)
+                continue;
+            m_Stamp[(size_t)count] = m_Epoch;
+            int mines = origin[count] & Board::COUNT_MASK;
+            for (ptrdiff_t around : neighbors)
+            {
+                unsigned char cell = origin[count + around];
+                mines -= IsExplodedMine(cell);
+                if (IsHidden(cell) && m_Stamp[(size_t)(count + around)] != m_Epoch)
+                {
+                    m_Stamp[(size_t)(count + around)] = m_Epoch;
+                    cells.push_back((uint32_t)(count + around));
+                }
+            }
+            counts.push_back((uint32_t)count);
+            counts.push_back((uint32_t)mines);
+        }
+    }
+}
+
+bool ProbabilityEngine::CountAssignments(Component& component, const std::vector<std::vector<int>>& constraintCells,
+                                         const std::vector<int>& constraintMines)
+{
+    const size_t cellCount = component.Cells.size();
+    const size_t constraintCount = constraintCells.size();
+    std::vector<std::vector<int>> cellConstraints(cellCount);
+    for (size_t c = 0; c < constraintCount; c++)
+        for (int cell : constraintCells[c])
+            cellConstraints[(size_t)cell].push_back((int)c);
+
+    // renumber the cells in counting order; a constraint is open from its
+    // first cell to its last
+    std::vector<int> order = CountingOrder(cellCount, cellConstraints, constraintCells);
+    std::vector<int> position(cellCount);
+    for (size_t i = 0; i < cellCount; i++)
+        position[(size_t)order[i]] = (int)i;
+    std::vector<std::vector<int>> positions(constraintCount);
+    for (size_t c = 0; c < constraintCount; c++)
+    {
+        for (int cell : constraintCells[c])
+            positions[c].push_back(position[(size_t)cell]);
+        std::sort(positions[c].begin(), positions[c].end());
+    }
+    std::vector<std::vector<int>> opening(cellCount);
+    for (size_t c = 0; c < constraintCount; c++)
+        opening[(size_t)positions[c].front()].push_back((int)c);
+
+    // the open constraints before each cell, as state slots, and how
+    // assigning the cell moves them
+    std::vector<std::vector<Touch>> touches(cellCount);
+    std::vector<int> open;
+    for (size_t d = 0; d < cellCount; d++)
+    {
+        std::vector<int> touched = open;
+        touched.insert(touched.end(), opening[d].begin(), opening[d].end());
+        std::vector<int> next;
+        for (int c : touched)
+            if (positions[(size_t)c].back() != (int)d)
+                next.push_back(c);
+        for (int c : touched)
+        {
+            const std::vector<int>& cells = positions[(size_t)c];
+            Touch touch;
+            auto from = std::find(open.begin(), open.end(), c);
+            auto to = std::find(next.begin(), next.end(), c);
+            touch.FromSlot = from == open.end() ? -1 : (int)(from - open.begin());
+            touch.ToSlot = to == next.end() ? -1 : (int)(to - next.begin());
+            touch.Mines = constraintMines[(size_t)c];
+            touch.After = (int)(cells.end() - std::upper_bound(cells.begin(), cells.end(), (int)d));
+            touch.Contains = std::binary_search(cells.begin(), cells.end(), (int)d);
+            touches[d].push_back(touch);
+        }
+        open.swap(next);
+    }
+
+    // forward: every state reachable before each cell, with the mines spent
+    // on the cells before it
+    std::vector<Layer> layers(cellCount + 1);
+    layers[0].Find(std::string());
+    layers[0].Forward[0].Values.assign(1, 1.0);
+    for (size_t d = 0; d < cellCount; d++)
+    {
+        Layer& layer = layers[d];
+        Layer& nextLayer = layers[d + 1];
+        size_t nextSlots = 0;
+        for (const Touch& touch : touches[d])
+            nextSlots += touch.ToSlot >= 0;
+        for (int v = 0; v < 2; v++)
+            layer.Next[v].assign(layer.Keys.size(), -1);
+        for (size_t s = 0; s < layer.Keys.size(); s++)
+        {
+            for (int v = 0; v < 2; v++)
+            {
+                std::string key(nextSlots, '\0');
+                bool valid = true;
+                for (const Touch& touch : touches[d])
+                {
+                    int owed = (touch.FromSlot >= 0 ? (int)layer.Keys[s][(size_t)touch.FromSlot] : touch.Mines) - (touch.Contains ? v : 0);
+                    if (owed < 0 || owed > touch.After)
+                    {
+                        valid = false;
+                        break;
+                    }
+                    if (touch.ToSlot >= 0)
+                        key[(size_t)touch.ToSlot] = (char)owed;
+                }
+                if (!valid)
+                    continue;
+                int next = nextLayer.Find(key);
+                layer.Next[v][s] = next;
+                nextLayer.Forward[(size_t)next].Add(layer.Forward[s], v);
+            }
+        }
+        if (nextLayer.Keys.empty())
+            return false;
+        nextLayer.Normalize(nextLayer.Forward);
+    }
+
+    // backward: the assignments of the cells from each state on
+    layers[cellCount].Backward.assign(layers[cellCount].Keys.size(), MineCounts());
+    layers[cellCount].Backward[0].Values.assign(1, 1.0);
+    for (size_t d = cellCount; d-- > 0;)
+    {
+        Layer& layer = layers[d];
+        layer.Backward.assign(layer.Keys.size(), MineCounts());
+        for (size_t s = 0; s < layer.Keys.size(); s++)
+            for (int v = 0; v < 2; v++)
+                if (layer.Next[v][s] >= 0)
+                    layer.Backward[s].Add(layers[d + 1].Backward[(size_t)layer.Next[v][s]], v);
+        layer.Normalize(layer.Backward);
+    }
+
+    const MineCounts& total = layers[0].Backward[0];
+    size_t first = 0, last = total.Values.size();
+    while (first < last && total.Values[first] == 0.0)
+        first++;
+    while (last > first && total.Values[last - 1] == 0.0)
+        last--;
+    if (first == last)
+        return false;
+    component.MinMines = total.Offset + (int)first;
+    component.Weights.assign(total.Values.begin() + (ptrdiff_t)first, total.Values.begin() + (ptrdiff_t)last);
+
+    // per cell, assignments with it a mine over all assignments, by mines;
+    // both sums come from the same layers, so their scales cancel
+    const size_t span = component.Weights.size();
+    std::vector<uint32_t> cells(cellCount);
+    for (size_t i = 0; i < cellCount; i++)
+        cells[i] = component.Cells[(size_t)order[i]];
+    component.Cells.swap(cells);
+    component.Conditional.assign(cellCount * span, 0.0);
+    std::vector<double> all(cellCount + 2), mine(cellCount + 2);
+    for (size_t d = 0; d < cellCount; d++)
+    {
+        const Layer& layer = layers[d];
+        std::fill(all.begin(), all.end(), 0.0);
+        std::fill(mine.begin(), mine.end(), 0.0);
+        for (size_t s = 0; s < layer.Keys.size(); s++)
+        {
+            for (int v = 0; v < 2; v++)
+            {
+                if (layer.Next[v][s] < 0)
+                    continue;
+                const MineCounts& after = layers[d + 1].Backward[(size_t)layer.Next[v][s]];
+                AddProduct(all, layer.Forward[s], after, v);
+                if (v)
+                    AddProduct(mine, layer.Forward[s], after, v);
+            }
+        }
+        for (size_t m = 0; m < span; m++)
+        {
+            size_t mines = (size_t)component.MinMines + m;
+            component.Conditional[d * span + m] = all[mines] > 0.0 ? mine[mines] / all[mines] : 0.0;
+        }
+    }
+    return true;
+}
+
+bool ProbabilityEngine::SettleRegion(const std::vector<uint32_t>& cells, const std::vector<uint32_t>& counts)
+{
+    // constraints over indices into cells; every hidden neighbor of a
+    // region's count is in the region
+    const unsigned char* origin = m_Board.GetCellData();
+    const ptrdiff_t stride = (ptrdiff_t)m_Stride;
+    const ptrdiff_t neighbors[8] = { -stride - 1, -stride, -stride + 1, -1, 1, stride - 1, stride, stride + 1 };
+    const size_t constraintCount = counts.size() / 2;
+    for (size_t i = 0; i < cells.size(); i++)
+        m_LocalIndex[cells[i]] = (int)i;
+    std::vector<Links> constraintCells(constraintCount);
+    std::vector<int> owed(constraintCount);
+    std::vector<Links> cellConstraints(cells.size());
+    for (size_t c = 0; c < constraintCount; c++)
+    {
+        owed[c] = (int)counts[2 * c + 1];
+        for (ptrdiff_t offset : neighbors)
+        {
+            ptrdiff_t neighbor = (ptrdiff_t)counts[2 * c] + offset;
+            if (!IsHidden(origin[neighbor]))
+                continue;
+            int cell = m_LocalIndex[(size_t)neighbor];
+            constraintCells[c].Push(cell);
+            cellConstraints[(size_t)cell].Push((int)c);
+        }
+    }
+
+    // counts with no mines owed or as many as cells left settle them
+    std::vector<signed char> value(cells.size(), -1);
+    std::vector<int> unknown(constraintCount);
+    std::vector<int> queue(constraintCount);
+    for (size_t c = 0; c < constraintCount; c++)
+    {
+        unknown[c] = constraintCells[c].Size;
+        queue[c] = (int)c;
+    }
+    while (!queue.empty())
+    {
+        int c = queue.back();
+        queue.pop_back();
+        if (owed[(size_t)c] < 0 || owed[(size_t)c] > unknown[(size_t)c])
+            return false;
+        if (unknown[(size_t)c] == 0 || (owed[(size_t)c] != 0 && owed[(size_t)c] != unknown[(size_t)c]))
+            continue;
+        signed char settle = owed[(size_t)c] != 0;
+        for (int cell : constraintCells[(size_t)c])
+        {
+            if (value[(size_t)cell] >= 0)
+                continue;
+            value[(size_t)cell] = settle;
+            m_Probabilities[cells[(size_t)cell]] = settle;
+            if (settle)
+                m_SettledMines.push_back(cells[(size_t)cell]);
+            for (int other : cellConstraints[(size_t)cell])
+            {
+                unknown[(size_t)other]--;
+                owed[(size_t)other] -= settle;
+                queue.push_back(other);
+            }
+        }
+    }
+
+    // what is left splits into components joined by the counts still open
+    std::vector<int> parent(cells.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    auto root = [&](int cell)
+    {
+        while (parent[(size_t)cell] != cell)
+            cell = parent[(size_t)cell] = parent[(size_t)parent[(size_t)cell]];
+        return cell;
+    };
+    for (size_t c = 0; c < constraintCount; c++)
+    {
+        int first = -1;
+        for (int cell : constraintCells[c])
+        {
+            if (value[(size_t)cell] >= 0)
+                continue;
+            if (first < 0)
+                first = root(cell);
+            else
+                parent[(size_t)root(cell)] = first;
+        }
+    }
+    struct Pending
+    {
+        std::vector<uint32_t> Key;      // sorted cells, then sorted (count cell, mines owed) pairs
+        std::vector<int> Constraints;
+    };
+    std::vector<Pending> pending;
+    std::vector<int> componentOf(cells.size(), -1), local(cells.size());
+    for (size_t cell = 0; cell < cells.size(); cell++)
+    {
+        if (value[cell] >= 0)
+            continue;
+        int r = root((int)cell);
+        if (componentOf[(size_t)r] < 0)
+        {
+            componentOf[(size_t)r] = (int)pending.size();
+            pending.emplace_back();
+        }
+        std::vector<uint32_t>& key = pending[(size_t)componentOf[(size_t)r]].Key;
+        local[cell] = (int)key.size();
+        key.push_back(cells[cell]);
+    }
+    std::vector<std::pair<uint32_t, int>> pairs;
+    for (size_t c = 0; c < constraintCount; c++)
+    {
+        for (int cell : constraintCells[c])
+        {
+            if (value[(size_t)cell] < 0)
+            {
+                pending[(size_t)componentOf[(size_t)root(cell)]].Constraints.push_back((int)c);
+                break;
+            }
+        }
+    }
+
+    for (Pending& component : pending)
+    {
+        const size_t cellCount = component.Key.size();
+        pairs.clear();
+        for (int c : component.Constraints)
+            pairs.emplace_back(counts[2 * (size_t)c], c);
+        std::sort(pairs.begin(), pairs.end());
+        component.Key.push_back(UINT32_MAX);
+        for (const auto& pair : pairs)
+        {
+            component.Key.push_back(pair.first);
+            component.Key.push_back((uint32_t)owed[(size_t)pair.second]);
+        }
+
+        auto found = m_Cache.emplace(component.Key, Component());
+        Component& counted = found.first->second;
+        if (found.second)
+        {
+            std::vector<std::vector<int>> openCells;
+            std::vector<int> openMines;
+            for (int c : component.Constraints)
+            {
+                openCells.emplace_back();
+                for (int cell : constraintCells[(size_t)c])
+                    if (value[(size_t)cell] < 0)
+                        openCells.back().push_back(local[(size_t)cell]);
+                openMines.push_back(owed[(size_t)c]);
+            }
+            counted.Cells.assign(component.Key.begin(), component.Key.begin() + (ptrdiff_t)cellCount);
+            counted.Consistent = CountAssignments(counted, openCells, openMines);
+            m_RecountedCount++;
+        }
+        counted.LastUsed = m_Epoch;
+        m_Components.push_back(&counted);
+        if (!counted.Consistent)
+            return false;
+    }
+    return true;
+}
+
+void ProbabilityEngine::Update()
+{
+    const unsigned char* origin = m_Board.GetCellData();
+    if (++m_Epoch == 0)
+    {
+        std::fill(m_Stamp.begin(), m_Stamp.end(), 0);
+        m_Epoch = 1;
+    }
+
+    // Frontier cells are found eight at a time: hidden cells with a count
+    // among the 24 bytes around them. The border is never either; the row
+    // lead and the 8 padding bytes after every row, the bottom border's
+    // too, keep the reads at x - 1 and x + 1 inside the allocation.
+    std::vector<uint32_t> cells, counts;
+    long long hidden = 0, exploded = 0;
+    bool consistent = true;
+    m_Components.clear();
+    m_SettledMines.clear();
+    m_Frontier.clear();
+    m_RecountedCount = 0;
+    for (int y = 0; y < m_Height; y++)
+    {
+        const unsigned char* row = origin + (size_t)y * m_Stride;
+        for (int x = 0; x < m_Width; x += 8)
+        {
+            uint64_t word = Load(row + x);
+            uint64_t hiddenBytes = HiddenBytes(word);
+            hidden += PopCount(hiddenBytes);
+            exploded += PopCount(ExplodedBytes(word));
+            if (!hiddenBytes)
+                continue;
+            uint64_t near = 0;
+            for (const unsigned char* around = row - m_Stride; around <= row + m_Stride; around += m_Stride)
+                near |= CountBytes(Load(around + x - 1)) | CountBytes(Load(around + x)) | CountBytes(Load(around + x + 1));
+            for (uint64_t frontier = hiddenBytes & near; frontier; frontier &= frontier - 1)
+            {
+                const uint32_t offset = (uint32_t)((size_t)y * m_Stride + (size_t)x) + (uint32_t)(LowestBit(frontier) >> 3);
+                if (m_Stamp[offset] == m_Epoch)
+                    continue;
+                CollectRegion(offset, cells, counts);
+                m_Frontier.insert(m_Frontier.end(), cells.begin(), cells.end());
+                std::sort(cells.begin(), cells.end());
+                consistent = SettleRegion(cells, counts) && consistent;
+            }
+        }
+    }
+    for (auto entry = m_Cache.begin(); entry != m_Cache.end();)
+        entry = entry->second.LastUsed == m_Epoch ? std::next(entry) : m_Cache.erase(entry);
+
+    // Components with the same weights are interchangeable, so they are
+    // weighed as a group: weights^members.
+    long long fewestMines = (long long)m_SettledMines.size();
+    long long spread = 0;
+    std::map<std::vector<double>, int> groupOf;
+    std::vector<const std::vector<double>*> groupWeights;
+    std::vector<int> groupMembers;
+    for (const Component* component : m_Components)
+    {
+        fewestMines += component->MinMines;
+        spread += (long long)component->Weights.size() - 1;
+        auto found = groupOf.emplace(component->Weights, (int)groupWeights.size());
+        if (found.second)
+        {
+            groupWeights.push_back(&found.first->first);
+            groupMembers.push_back(0);
+        }
+        groupMembers[(size_t)found.first->second]++;
+    }
+
+    const long long interior = hidden - (long long)m_Frontier.size();
+    const long long minesLeft = (long long)m_Board.GetMineCount() - exploded;
+    // weight of x frontier mines beyond the fewest, C(interior, mines left - fewest - x)
+    std::vector<double> interiorWeights((size_t)spread + 1, 0.0);
+    double maxLog = -INFINITY;
+    std::vector<double> logs((size_t)spread + 1, -INFINITY);
+    for (long long x = 0; x <= spread; x++)
+    {
+        long long rest = minesLeft - fewestMines - x;
+        if (rest >= 0 && rest <= interior)
+        {
+            logs[(size_t)x] = LogChoose((int)interior, (int)rest);
+            maxLog = std::max(maxLog, logs[(size_t)x]);
+        }
+    }
+    if (!consistent || maxLog == -INFINITY)
+    {
+        // the board contradicts itself; fall back to the plain density
+        m_InteriorProbability = hidden ? (float)std::min(1.0, std::max(0.0, (double)minesLeft / (double)hidden)) : 0.0f;
+        for (uint32_t offset : m_Frontier)
+            m_Probabilities[offset] = m_InteriorProbability;
+        return;
+    }
+    for (size_t x = 0; x < logs.size(); x++)
+        interiorWeights[x] = logs[x] == -INFINITY ? 0.0 : std::exp(logs[x] - maxLog);
+
+    // Prefix[g] weighs the groups before g; walking back, rest holds, for
+    // x mines in those groups, the weight of everything after them, so a
+    // component with m mines in group g weighs sum over a of Prefix[g][a] *
+    // rest'[m + a], rest' leaving one member of the group out.
+    const size_t groupCount = groupWeights.size();
+    std::vector<std::vector<double>> prefix(groupCount + 1);
+    std::vector<double> scratch;
+    prefix[0].assign(1, 1.0);
+    for (size_t g = 0; g < groupCount; g++)
+    {
+        prefix[g + 1] = prefix[g];
+        for (int member = 0; member < groupMembers[g]; member++)
+            Convolve(prefix[g + 1], *groupWeights[g], scratch);
+    }
+    double total = 0.0, interiorMines = 0.0;
+    for (size_t x = 0; x < prefix[groupCount].size() && x < interiorWeights.size(); x++)
+    {
+        double weight = prefix[groupCount][x] * interiorWeights[x];
+        total += weight;
+        interiorMines += weight * (double)(minesLeft - fewestMines - (long long)x);
+    }
+    m_InteriorProbability = interior > 0 && total > 0.0 ? (float)(interiorMines / total / (double)interior) : 0.0f;
+
+    std::vector<std::vector<double>> componentWeights(groupCount);
+    std::vector<double> rest = interiorWeights;
+    for (size_t g = groupCount; g-- > 0;)
+    {
+        const std::vector<double>& weights = *groupWeights[g];
+        for (int member = 1; member < groupMembers[g]; member++)
+            ApplyWeights(rest, weights, scratch);
+        componentWeights[g].assign(weights.size(), 0.0);
+        for (size_t m = 0; m < weights.size(); m++)
+            for (size_t a = 0; a < prefix[g].size() && m + a < rest.size(); a++)
+                componentWeights[g][m] += prefix[g][a] * rest[m + a];
+        ApplyWeights(rest, weights, scratch);
+    }
+
+    for (const Component* component : m_Components)
+    {
+        const std::vector<double>& weights = componentWeights[(size_t)groupOf.find(component->Weights)->second];
+        const size_t span = component->Weights.size();
+        double componentTotal = 0.0;
+        for (size_t m = 0; m < span; m++)
+            componentTotal += component->Weights[m] * weights[m];
+        for (size_t i = 0; i < component->Cells.size(); i++)
+        {
+            double mine = 0.0;
+            for (size_t m = 0; m < span; m++)
+                mine += component->Weights[m] * weights[m] * component->Conditional[i * span + m];
+            m_Probabilities[component->Cells[i]] = componentTotal > 0.0 ? (float)(mine / componentTotal) : 0.0f;
+        }
+    }
+}
+
+float ProbabilityEngine::GetProbability(int x, int y) const
+{
+    const size_t offset = (size_t)y * m_Stride + (size_t)x;
+    switch (m_Board.GetState(x, y))
+    {
+        case CellState::REVEALED:
+            return 0.0f;
+        case CellState::MEME:
+            return 1.0f;
+        default:
+            return m_Stamp[offset] == m_Epoch ? m_Probabilities[offset] : m_InteriorProbability;
+    }
+}
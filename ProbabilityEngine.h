@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class Board;
+
+// Exact mine probabilities for the hidden cells of a board, from its
+// revealed counts and mine count alone (flags are the player's guesses and
+// are not trusted; an exploded mine is known).
+//
+// Hidden cells next to a revealed count form the frontier. A region of it
+// -- cells linked, directly or through others, by counts they share -- is
+// first reduced by the counts that settle their cells outright, which cuts
+// long frontiers apart; what is left splits into independent components,
+// linked by the counts still open. A component's consistent assignments are
+// counted per number of mines by a dynamic program over its cells in
+// breadth-first order: backtracking in which the mines still owed to the
+// counts open at a cell are memoized, so each distinct state is expanded
+// once. The remaining hidden cells, the interior, are unconstrained: a
+// layout with M mines on the frontier is weighted by the C(interior, mines
+// left - M) ways to place the rest, which is what couples the components.
+//
+// A component's counts only depend on its own cells and open counts, so they
+// are cached across updates under that key; an update recounts only the
+// components the moves since the last one touched, then re-weighs them all.
+class ProbabilityEngine
+{
+private:
+    struct Component
+    {
+        std::vector<uint32_t> Cells;        // cell offsets, in the order counted
+        int MinMines;
+        std::vector<double> Weights;        // assignments with MinMines + m mines, scaled
+        std::vector<double> Conditional;    // per cell, P(mine | MinMines + m mines)
+        bool Consistent;
+        uint32_t LastUsed;
+    };
+
+    // keyed by sorted cells, then sorted (count cell, mines owed) pairs
+    struct KeyHash
+    {
+        size_t operator()(const std::vector<uint32_t>& key) const;
+    };
+
+    const Board& m_Board;
+    int m_Width;
+    int m_Height;
+    size_t m_Stride;
+    std::unordered_map<std::vector<uint32_t>, Component, KeyHash> m_Cache;
+    std::vector<Component*> m_Components;   // those of the last Update
+    std::vector<uint32_t> m_SettledMines;
+    std::vector<uint32_t> m_Frontier;
+    std::vector<float> m_Probabilities;     // per cell offset, for frontier cells
+    std::vector<uint32_t> m_Stamp;          // per cell offset, m_Epoch once collected
+    std::vector<int> m_LocalIndex;          // per cell offset, its index in the region being settled
+    uint32_t m_Epoch;
+    float m_InteriorProbability;
+    size_t m_RecountedCount;
+
+    // the region holding a frontier cell: its cells and (count cell, mines) pairs
+    void CollectRegion(uint32_t start, std::vector<uint32_t>& cells, std::vector<uint32_t>& counts);
+    // settles a region's cells where a count allows, then looks up or counts
+    // the components left; false if the counts contradict each other
+    bool SettleRegion(const std::vector<uint32_t>& cells, const std::vector<uint32_t>& counts);
+    // constraints hold indices into component.Cells, which end up in counting order
+    static bool CountAssignments(Component& component, const std::vector<std::vector<int>>& constraintCells,
+                                 const std::vector<int>& constraintMines);
+public:
+    explicit ProbabilityEngine(const Board& board);
+
+    ProbabilityEngine(const ProbabilityEngine&) = delete;
+    ProbabilityEngine& operator=(const ProbabilityEngine&) = delete;
+
+    // Recomputes every probability from the board as it is now: a pass over
+    // the board eight cells at a time, a recount of the components not in
+    // the cache and a weighing of all of them together.
+    void Update();
+
+    // mine probability of a hidden cell as of the last Update; 0 for a
+    // revealed cell and 1 for an exploded mine
+    float GetProbability(int x, int y) const;
+    // shared by every hidden cell off the frontier
+    inline float GetInteriorProbability() const { return m_InteriorProbability; }
+
+    inline size_t GetComponentCount() const { return m_Components.size(); }
+    // components counted by the last Update rather than found in the cache
+    inline size_t GetRecountedCount() const { return m_RecountedCount; }
+    inline size_t GetFrontierCellCount() const { return m_Frontier.size(); }
+};
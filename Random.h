@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+
+// SplitMix64: a counter run through a strong 64-bit mix. Output n only
+// depends on (seed, n), so it doubles as a counter-based generator for
+// deriving independent streams, and it is the recommended way to seed
+// xoshiro from a single 64-bit value.
+struct SplitMix64
+{
+    uint64_t State;
+
+    explicit SplitMix64(uint64_t seed) : State(seed) {}
+
+    static inline uint64_t Mix(uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    inline uint64_t Next()
+    {
+        State += 0x9E3779B97F4A7C15ULL;
+        return Mix(State);
+    }
+
+    // output `counter` of the sequence seeded with `seed`, without stepping
+    static inline uint64_t At(uint64_t seed, uint64_t counter)
+    {
+        return Mix(seed + (counter + 1) * 0x9E3779B97F4A7C15ULL);
+    }
+};
+
+// xoshiro256** (Blackman and Vigna): 256 bits of state, period 2^256 - 1,
+// a handful of shifts and rotates per output. Not thread-safe; every thread
+// or band of work gets its own instance, seeded with ForStream.
+class Xoshiro256
+{
+private:
+    uint64_t m_State[4];
+
+    static inline uint64_t Rotate(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+public:
+    explicit Xoshiro256(uint64_t seed)
+    {
+        SplitMix64 seeder(seed);
+        for (uint64_t& word : m_State)
+            word = seeder.Next();
+    }
+
+    // independent generator number `stream` of a seed, in any order
+    static inline Xoshiro256 ForStream(uint64_t seed, uint64_t stream)
+    {
+        return Xoshiro256(SplitMix64::At(seed, stream));
+    }
+
+    inline uint64_t Next()
+    {
+        uint64_t result = Rotate(m_State[1] * 5, 7) * 9;
+        uint64_t t = m_State[1] << 17;
+        m_State[2] ^= m_State[0];
+        m_State[3] ^= m_State[1];
+        m_State[1] ^= m_State[2];
+        m_State[0] ^= m_State[3];
+        m_State[2] ^= t;
+        m_State[3] = Rotate(m_State[3], 45);
+        return result;
+    }
+
+    // uniform in [0, bound) without modulo bias (Lemire's multiply-shift with
+    // rejection of the short final interval), bound > 0
+    inline uint64_t NextBelow(uint64_t bound)
+    {
+#ifdef __SIZEOF_INT128__
+        unsigned __int128 product = (unsigned __int128)Next() * bound;
+        uint64_t low = (uint64_t)product;
+        if (low < bound)
+        {
+            uint64_t threshold = (0 - bound) % bound;
+            while (low < threshold)
+            {
+                product = (unsigned __int128)Next() * bound;
+                low = (uint64_t)product;
+            }
+        }
+        return (uint64_t)(product >> 64);
+#else
+        uint64_t threshold = (0 - bound) % bound;
+        uint64_t value;
+        do
+            value = Next();
+        while (value < threshold);
+        return value % bound;
+#endif
+    }
+
+    // uniform in [0, 1) with 53 random bits
+    inline double NextDouble() { return (double)(Next() >> 11) * (1.0 / 9007199254740992.0); }
+};
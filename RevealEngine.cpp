@@ -0,0 +1,466 @@
+#include "RevealEngine.h"
+#include "Board.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const unsigned char s_Revealed = (unsigned char)((int)CellState::REVEALED << Board::STATE_SHIFT);
+const uint64_t s_ByteOnes = 0x0101010101010101ULL;
+// the bits that are all clear in a hidden, mine-free interior cell
+const uint64_t s_NotSafeBits = s_ByteOnes * (Board::STATE_MASK | Board::MINE_BIT | Board::BORDER_BIT);
+
+// spans handed out per steal, and spans a worker may expand from its own
+// next frontier before the level ends
+const size_t s_FrontierChunk = 64;
+const size_t s_LevelSpans = 4096;
+
+static_assert(Board::CHUNK_SIZE == 64, "a chunk column is one word of the visited bitmap");
+
+// hidden, not a mine and not border; the rest of the byte is the count
+inline bool IsHiddenSafe(unsigned char cell)
+{
+    return (cell & (Board::STATE_MASK | Board::MINE_BIT | Board::BORDER_BIT)) == 0;
+}
+
+inline size_t RevealNumbered(unsigned char& cell)
+{
+    if (!IsHiddenSafe(cell))
+        return 0;
+    cell = (unsigned char)((cell & ~Board::STATE_MASK) | s_Revealed);
+    return 1;
+}
+
+// true when some byte of the word is 0
+inline bool HasZeroByte(uint64_t word)
+{
+    return ((word - s_ByteOnes) & ~word & 0x8080808080808080ULL) != 0;
+}
+
+// 0x80 in every byte that is not 0, exact (no borrow between bytes)
+inline uint64_t NonZeroBytes(uint64_t word)
+{
+    return (((word & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | word) & 0x8080808080808080ULL;
+}
+
+// 0x80 in byte i for every bit i of bits
+inline uint64_t SpreadBits(unsigned int bits)
+{
+    return NonZeroBytes((bits * s_ByteOnes) & 0x8040201008040201ULL);
+}
+
+inline int PopCount(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    int count = 0;
+    for (; word; word &= word - 1)
+        count++;
+    return count;
+#endif
+}
+
+// Ends of the run of 0 cells through x. Eight cells are tested per step
+// while the run lasts; the border stops both scans, and the row lead and
+// padding keep the 8-byte reads inside the allocation.
+inline int ExtendLeft(const unsigned char* row, int x)
+{
+    uint64_t word;
+    while (std::memcpy(&word, row + x - 8, 8), word == 0)
+        x -= 8;
+    while (row[x - 1] == 0)
+        x--;
+    return x;
+}
+
+inline int ExtendRight(const unsigned char* row, int x)
+{
+    uint64_t word;
+    while (std::memcpy(&word, row + x + 1, 8), word == 0)
+        x += 8;
+    while (row[x + 1] == 0)
+        x++;
+    return x;
+}
+
+inline void OrWord(std::atomic<uint64_t>& word, uint64_t mask)
+{
+    word.store(word.load(std::memory_order_relaxed) | mask, std::memory_order_relaxed);
+}
+
+// word k of a visited row widened by one cell either way
+inline uint64_t Dilate(const std::atomic<uint64_t>* row, size_t k, size_t words)
+{
+    if (!row)
+        return 0;
+    uint64_t word = row[k].load(std::memory_order_relaxed);
+    uint64_t left = k > 0 ? row[k - 1].load(std::memory_order_relaxed) : 0;
+    uint64_t right = k + 1 < words ? row[k + 1].load(std::memory_order_relaxed) : 0;
+    return word | (word << 1) | (left >> 63) | (word >> 1) | (right << 63);
+}
+
+}
+
+RevealEngine::RevealEngine()
+    : m_VisitedWords(0), m_WorkerCount(0), m_Width(0), m_Height(0), m_ChunkColumns(0)
+{
+}
+
+void RevealEngine::Reserve(int width, int height)
+{
+    if (width == m_Width && height == m_Height)
+        return;
+    m_Width = width;
+    m_Height = height;
+    m_VisitedWords = ((size_t)width + 63) / 64;
+    m_Visited.reset(new std::atomic<uint64_t>[m_VisitedWords * height]);
+    ClearVisited(0, height - 1);
+    m_ChunkColumns = (width + Board::CHUNK_SIZE - 1) / Board::CHUNK_SIZE;
+    m_DirtyMap.assign((size_t)m_ChunkColumns * ((height + Board::CHUNK_SIZE - 1) / Board::CHUNK_SIZE), 0);
+    m_Stack.reserve(std::max<size_t>(m_Stack.capacity(), 1024));
+}
+
+void RevealEngine::MarkVisited(int first, int last, int y)
+{
+    std::atomic<uint64_t>* row = m_Visited.get() + (size_t)y * m_VisitedWords;
+    int firstWord = first >> 6, lastWord = last >> 6;
+    uint64_t firstMask = ~(uint64_t)0 << (first & 63);
+    uint64_t lastMask = ~(uint64_t)0 >> (63 - (last & 63));
+    if (firstWord == lastWord)
+    {
+        OrWord(row[firstWord], firstMask & lastMask);
+        return;
+    }
+    OrWord(row[firstWord], firstMask);
+    for (int k = firstWord + 1; k < lastWord; k++)
+        row[k].store(~(uint64_t)0, std::memory_order_relaxed);
+    OrWord(row[lastWord], lastMask);
+}
+
+bool RevealEngine::ClaimRun(int first, int last, int y)
+{
+    std::atomic<uint64_t>* row = m_Visited.get() + (size_t)y * m_VisitedWords;
+    int firstWord = first >> 6, lastWord = last >> 6;
+    uint64_t bit = (uint64_t)1 << (first & 63);
+    if ((row[firstWord].load(std::memory_order_relaxed) & bit) || (row[firstWord].fetch_or(bit, std::memory_order_relaxed) & bit))
+        return false;
+
+    // the rest of the run is ours, but its end words may be shared with
+    // runs other workers are claiming
+    uint64_t firstMask = ~(uint64_t)0 << (first & 63);
+    uint64_t lastMask = ~(uint64_t)0 >> (63 - (last & 63));
+    if (firstWord == lastWord)
+    {
+        row[firstWord].fetch_or(firstMask & lastMask, std::memory_order_relaxed);
+        return true;
+    }
+    row[firstWord].fetch_or(firstMask, std::memory_order_relaxed);
+    for (int k = firstWord + 1; k < lastWord; k++)
+        row[k].store(~(uint64_t)0, std::memory_order_relaxed);
+    row[lastWord].fetch_or(lastMask, std::memory_order_relaxed);
+    return true;
+}
+
+void RevealEngine::ClearVisited(int firstRow, int lastRow)
+{
+    std::atomic<uint64_t>* word = m_Visited.get() + (size_t)firstRow * m_VisitedWords;
+    std::atomic<uint64_t>* end = m_Visited.get() + (size_t)(lastRow + 1) * m_VisitedWords;
+    for (; word != end; ++word)
+        word->store(0, std::memory_order_relaxed);
+}
+
+void RevealEngine::MarkDirty(int firstX, int lastX, int firstY, int lastY)
+{
+    for (int cy = firstY / Board::CHUNK_SIZE; cy <= lastY / Board::CHUNK_SIZE; cy++)
+        for (int cx = firstX / Board::CHUNK_SIZE; cx <= lastX / Board::CHUNK_SIZE; cx++)
+            m_DirtyMap[(size_t)cy * m_ChunkColumns + cx] = 1;
+}
+
+void RevealEngine::CollectDirty(int firstRow, int lastRow, std::vector<uint32_t>& dirtyChunks)
+{
+    for (int cy = firstRow / Board::CHUNK_SIZE; cy <= lastRow / Board::CHUNK_SIZE; cy++)
+    {
+        unsigned char* flags = m_DirtyMap.data() + (size_t)cy * m_ChunkColumns;
+        for (int cx = 0; cx < m_ChunkColumns; cx++)
+        {
+            if (flags[cx])
+            {
+                dirtyChunks.push_back((uint32_t)cy * m_ChunkColumns + cx);
+                flags[cx] = 0;
+            }
+        }
+    }
+}
+
+size_t RevealEngine::Reveal(unsigned char* cells, size_t stride, int x, int y, std::vector<uint32_t>& dirtyChunks, ThreadPool* pool)
+{
+    unsigned char* start = cells + (ptrdiff_t)y * (ptrdiff_t)stride + x;
+    if (*start != 0)
+    {
+        size_t revealed = RevealNumbered(*start);
+        if (revealed)
+            dirtyChunks.push_back((uint32_t)(y / Board::CHUNK_SIZE) * m_ChunkColumns + x / Board::CHUNK_SIZE);
+        return revealed;
+    }
+
+    int first = ExtendLeft(cells + (ptrdiff_t)y * (ptrdiff_t)stride, x);
+    int last = ExtendRight(cells + (ptrdiff_t)y * (ptrdiff_t)stride, x);
+    MarkVisited(first, last, y);
+    m_Stack.push_back({ first, last, y });
+    int firstRow = y, lastRow = y;
+
+    // small openings never leave this thread; large ones carry on from
+    // whatever is left on the stack
+    bool parallel = pool && pool->GetThreadCount() > 1;
+    size_t revealed = FloodSerial(cells, stride, parallel ? s_SerialCells : std::numeric_limits<size_t>::max(), firstRow, lastRow);
+    if (!m_Stack.empty())
+    {
+        FloodParallel(cells, stride, *pool, firstRow, lastRow);
+        revealed += RevealClaimed(cells, stride, std::max(firstRow - 1, 0), std::min(lastRow + 1, m_Height - 1), *pool);
+    }
+
+    CollectDirty(std::max(firstRow - 1, 0), std::min(lastRow + 1, m_Height - 1), dirtyChunks);
+    ClearVisited(firstRow, lastRow);
+    return revealed;
+}
+
+size_t RevealEngine::FloodSerial(unsigned char* cells, size_t stride, size_t limit, int& firstRow, int& lastRow)
+{
+    size_t revealed = 0;
+    while (!m_Stack.empty() && revealed < limit)
+    {
+        Span span = m_Stack.back();
+        m_Stack.pop_back();
+
+        unsigned char* row = cells + (ptrdiff_t)span.Y * (ptrdiff_t)stride;
+        std::memset(row + span.First, s_Revealed, span.Last - span.First + 1);
+        revealed += span.Last - span.First + 1;
+        revealed += RevealNumbered(row[span.First - 1]) + RevealNumbered(row[span.Last + 1]);
+        MarkDirty(std::max(span.First - 1, 0), std::min(span.Last + 1, m_Width - 1),
+                  std::max(span.Y - 1, 0), std::min(span.Y + 1, m_Height - 1));
+
+        // the rows above and below, diagonals included
+        for (int ny = span.Y - 1; ny <= span.Y + 1; ny += 2)
+        {
+            if (ny < 0 || ny >= m_Height)
+                continue;
+            unsigned char* next = cells + (ptrdiff_t)ny * (ptrdiff_t)stride;
+            int nx = span.First - 1;
+            while (nx <= span.Last + 1)
+            {
+                // eight cells that are all revealed, flagged or mines need nothing;
+                // hidden safe cells are the only ones with a zero high nibble
+                uint64_t word;
+                std::memcpy(&word, next + nx, 8);
+                if (nx + 7 <= span.Last + 1 && !HasZeroByte(word & 0xF0F0F0F0F0F0F0F0ULL))
+                {
+                    nx += 8;
+                    continue;
+                }
+
+                if (next[nx] != 0)
+                {
+                    revealed += RevealNumbered(next[nx]);
+                    nx++;
+                }
+                else if (IsVisited(nx, ny))
+                {
+                    // a queued run is whole, skip to its end
+                    nx = ExtendRight(next, nx) + 1;
+                }
+                else
+                {
+                    int runFirst = ExtendLeft(next, nx);
+                    int runLast = ExtendRight(next, nx);
+                    MarkVisited(runFirst, runLast, ny);
+                    m_Stack.push_back({ runFirst, runLast, ny });
+                    firstRow = std::min(firstRow, ny);
+                    lastRow = std::max(lastRow, ny);
+                    nx = runLast + 1;
+                }
+            }
+        }
+    }
+    return revealed;
+}
+
+void RevealEngine::FloodParallel(const unsigned char* cells, size_t stride, ThreadPool& pool, int& firstRow, int& lastRow)
+{
+    if (m_WorkerCount != pool.GetThreadCount())
+    {
+        m_WorkerCount = pool.GetThreadCount();
+        m_Workers.reset(new Worker[m_WorkerCount]);
+    }
+
+    // the serial flood's stack is the first frontier, dealt out in slices
+    size_t slice = (m_Stack.size() + m_WorkerCount - 1) / m_WorkerCount;
+    for (unsigned int t = 0; t < m_WorkerCount; t++)
+    {
+        Worker& worker = m_Workers[t];
+        size_t begin = std::min(t * slice, m_Stack.size());
+        size_t end = std::min(begin + slice, m_Stack.size());
+        worker.Frontier.assign(m_Stack.begin() + begin, m_Stack.begin() + end);
+        worker.FirstRow = firstRow;
+        worker.LastRow = lastRow;
+    }
+    m_Stack.clear();
+
+    for (;;)
+    {
+        size_t frontier = 0;
+        for (unsigned int t = 0; t < m_WorkerCount; t++)
+            frontier += m_Workers[t].Frontier.size();
+        if (frontier == 0)
+            break;
+
+        for (unsigned int t = 0; t < m_WorkerCount; t++)
+        {
+            m_Workers[t].Cursor.store(0, std::memory_order_relaxed);
+            m_Workers[t].Next.clear();
+        }
+        for (unsigned int t = 0; t < m_WorkerCount; t++)
+            pool.Submit([this, cells, stride, t] { ExpandLevel(cells, stride, t); });
+        pool.Wait();
+        for (unsigned int t = 0; t < m_WorkerCount; t++)
+            m_Workers[t].Frontier.swap(m_Workers[t].Next);
+    }
+
+    for (unsigned int t = 0; t < m_WorkerCount; t++)
+    {
+        firstRow = std::min(firstRow, m_Workers[t].FirstRow);
+        lastRow = std::max(lastRow, m_Workers[t].LastRow);
+    }
+}
+
+void RevealEngine::ExpandLevel(const unsigned char* cells, size_t stride, unsigned int worker)
+{
+    Worker& self = m_Workers[worker];
+
+    // own frontier first, then whatever the other workers have not taken yet
+    for (unsigned int i = 0; i < m_WorkerCount; i++)
+    {
+        Worker& owner = m_Workers[(worker + i) % m_WorkerCount];
+        size_t size = owner.Frontier.size();
+        size_t chunk;
+        while ((chunk = owner.Cursor.fetch_add(s_FrontierChunk, std::memory_order_relaxed)) < size)
+        {
+            size_t end = std::min(chunk + s_FrontierChunk, size);
+            for (size_t k = chunk; k < end; k++)
+                ExpandSpan(cells, stride, owner.Frontier[k], self);
+        }
+    }
+
+    // Carrying on into runs this worker just claimed saves a barrier per
+    // level on long, thin openings; the budget keeps the work shareable.
+    for (size_t budget = s_LevelSpans; budget > 0 && !self.Next.empty(); budget--)
+    {
+        Span span = self.Next.back();
+        self.Next.pop_back();
+        ExpandSpan(cells, stride, span, self);
+    }
+}
+
+void RevealEngine::ExpandSpan(const unsigned char* cells, size_t stride, const Span& span, Worker& worker)
+{
+    // only the visited bitmap changes while the frontier grows, so every
+    // worker finds the same ends for a run and the claim decides who owns it
+    for (int ny = span.Y - 1; ny <= span.Y + 1; ny += 2)
+    {
+        if (ny < 0 || ny >= m_Height)
+            continue;
+        const unsigned char* next = cells + (ptrdiff_t)ny * (ptrdiff_t)stride;
+        int nx = span.First - 1;
+        while (nx <= span.Last + 1)
+        {
+            uint64_t word;
+            std::memcpy(&word, next + nx, 8);
+            if (nx + 7 <= span.Last + 1 && !HasZeroByte(word))
+            {
+                nx += 8;
+                continue;
+            }
+            if (next[nx] != 0)
+            {
+                nx++;
+                continue;
+            }
+            if (IsVisited(nx, ny))
+            {
+                nx = ExtendRight(next, nx) + 1;
+                continue;
+            }
+
+            int runFirst = ExtendLeft(next, nx);
+            int runLast = ExtendRight(next, nx);
+            if (ClaimRun(runFirst, runLast, ny))
+            {
+                worker.Next.push_back({ runFirst, runLast, ny });
+                worker.FirstRow = std::min(worker.FirstRow, ny);
+                worker.LastRow = std::max(worker.LastRow, ny);
+            }
+            nx = runLast + 1;
+        }
+    }
+}
+
+size_t RevealEngine::RevealClaimed(unsigned char* cells, size_t stride, int firstRow, int lastRow, ThreadPool& pool)
+{
+    // one task per chunk row, so each dirty flag has a single writer
+    int firstBand = firstRow / Board::CHUNK_SIZE;
+    int lastBand = lastRow / Board::CHUNK_SIZE;
+    std::vector<size_t> counts(lastBand - firstBand + 1, 0);
+    for (int band = firstBand; band <= lastBand; band++)
+    {
+        int bandFirst = std::max(firstRow, band * Board::CHUNK_SIZE);
+        int bandLast = std::min(lastRow, band * Board::CHUNK_SIZE + Board::CHUNK_SIZE - 1);
+        size_t& count = counts[band - firstBand];
+        pool.Submit([this, cells, stride, bandFirst, bandLast, &count] { count = RevealClaimedRows(cells, stride, bandFirst, bandLast); });
+    }
+    pool.Wait();
+
+    size_t revealed = 0;
+    for (size_t count : counts)
+        revealed += count;
+    return revealed;
+}
+
+size_t RevealEngine::RevealClaimedRows(unsigned char* cells, size_t stride, int firstRow, int lastRow)
+{
+    size_t revealed = 0;
+    for (int y = firstRow; y <= lastRow; y++)
+    {
+        unsigned char* row = cells + (ptrdiff_t)y * (ptrdiff_t)stride;
+        const std::atomic<uint64_t>* visited = m_Visited.get() + (size_t)y * m_VisitedWords;
+        const std::atomic<uint64_t>* above = y > 0 ? visited - m_VisitedWords : nullptr;
+        const std::atomic<uint64_t>* below = y + 1 < m_Height ? visited + m_VisitedWords : nullptr;
+        unsigned char* dirty = m_DirtyMap.data() + (size_t)(y / Board::CHUNK_SIZE) * m_ChunkColumns;
+
+        for (size_t k = 0; k < m_VisitedWords; k++)
+        {
+            // claimed cells and their neighbors; the hidden safe ones among
+            // them are revealed eight at a time, the rest are left alone
+            uint64_t reach = Dilate(above, k, m_VisitedWords) | Dilate(visited, k, m_VisitedWords) | Dilate(below, k, m_VisitedWords);
+            for (int group = 0; reach != 0; group++, reach >>= 8)
+            {
+                unsigned int bits = (unsigned int)(reach & 0xFF);
+                if (!bits)
+                    continue;
+                unsigned char* bytes = row + k * 64 + group * 8;
+                uint64_t word;
+                std::memcpy(&word, bytes, 8);
+                uint64_t select = ~NonZeroBytes(word & s_NotSafeBits) & SpreadBits(bits);
+                if (!select)
+                    continue;
+                word |= (select >> 7) * s_Revealed;
+                std::memcpy(bytes, &word, 8);
+                revealed += PopCount(select);
+                dirty[k] = 1;
+            }
+        }
+    }
+    return revealed;
+}
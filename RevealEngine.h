@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class ThreadPool;
+
+// Flood reveal over Board's cell bytes (see Board.h for the layout). A cell
+// byte of 0 is a hidden, mine-free cell with no adjacent mines -- the only
+// kind the flood spreads through -- and border cells are never 0, so runs of
+// them can be scanned without bounds checks.
+//
+// The flood works on horizontal runs of such cells rather than single
+// cells: a run is found by scanning left and right from a seed, marked in
+// the visited bitmap and pushed once; popping it reveals the run, reveals
+// the numbered cells around it and scans the rows above and below for
+// further runs. The span stack and the bitmap are kept between calls.
+//
+// Openings that outgrow s_SerialCells continue on a thread pool, level by
+// level: each worker expands its share of the frontier into a frontier of
+// its own for the next level, and a worker that runs out takes chunks of
+// the others' frontiers. Runs are claimed with an atomic test-and-set of
+// their first bit in the visited bitmap, and no cell byte is written until
+// the frontier is exhausted; the claimed runs and the numbered cells around
+// them are then revealed band by band.
+class RevealEngine
+{
+private:
+    struct Span
+    {
+        int First;
+        int Last;
+        int Y;
+    };
+
+    // one pool thread's frontiers; Cursor hands out chunks of Frontier to
+    // the owner and to workers stealing from it
+    struct alignas(64) Worker
+    {
+        std::vector<Span> Frontier;
+        std::vector<Span> Next;
+        std::atomic<size_t> Cursor;
+        int FirstRow;
+        int LastRow;
+    };
+
+    std::vector<Span> m_Stack;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_Visited;    // queued runs, one bit per cell
+    size_t m_VisitedWords;                                  // per row
+    std::vector<unsigned char> m_DirtyMap;                  // one byte per chunk
+    std::unique_ptr<Worker[]> m_Workers;
+    unsigned int m_WorkerCount;
+    int m_Width;
+    int m_Height;
+    int m_ChunkColumns;
+
+    inline bool IsVisited(int x, int y) const
+    {
+        return (m_Visited[(size_t)y * m_VisitedWords + (x >> 6)].load(std::memory_order_relaxed) >> (x & 63)) & 1;
+    }
+    void MarkVisited(int first, int last, int y);
+    // sets the run's first bit; false when another worker got there first
+    bool ClaimRun(int first, int last, int y);
+    void ClearVisited(int firstRow, int lastRow);
+    void MarkDirty(int firstX, int lastX, int firstY, int lastY);
+    void CollectDirty(int firstRow, int lastRow, std::vector<uint32_t>& dirtyChunks);
+
+    size_t FloodSerial(unsigned char* cells, size_t stride, size_t limit, int& firstRow, int& lastRow);
+    void FloodParallel(const unsigned char* cells, size_t stride, ThreadPool& pool, int& firstRow, int& lastRow);
+    void ExpandLevel(const unsigned char* cells, size_t stride, unsigned int worker);
+    void ExpandSpan(const unsigned char* cells, size_t stride, const Span& span, Worker& worker);
+    // reveals the claimed runs and their neighbors in rows [firstRow, lastRow]
+    size_t RevealClaimed(unsigned char* cells, size_t stride, int firstRow, int lastRow, ThreadPool& pool);
+    size_t RevealClaimedRows(unsigned char* cells, size_t stride, int firstRow, int lastRow);
+public:
+    // revealed cells before an opening moves to the pool
+    static const size_t s_SerialCells = (size_t)1 << 20;
+
+    RevealEngine();
+
+    // sizes the bitmap and stack for a board; reuses them if they fit
+    void Reserve(int width, int height);
+
+    // Reveals from (x, y), which must be a hidden, mine-free cell, and
+    // returns the number of cells revealed. cells points at cell (0, 0) and
+    // stride is the byte distance between rows. The chunks (see
+    // Board::CHUNK_SIZE) holding changed cells are appended to dirtyChunks.
+    // Large openings use the pool when one with several threads is given.
+    size_t Reveal(unsigned char* cells, size_t stride, int x, int y, std::vector<uint32_t>& dirtyChunks, ThreadPool* pool = nullptr);
+};
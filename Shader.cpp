@@ -15,11 +15,38 @@ Shader::Shader(const std::string &filepath)
     m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
 }
 
+Shader::Shader(const std::string &name, std::string_view source)
+    : m_FilePath(name), m_RendererID(0)
+{
+    ShaderProgramSource program = ParseShader(source);
+    m_RendererID = CreateShader(program.VertexSource, program.FragmentSource);
+}
+
 Shader::~Shader()
 {
     glDeleteProgram(m_RendererID);
 }
 
+Shader::Shader(Shader&& other) noexcept
+    : m_FilePath(std::move(other.m_FilePath)), m_RendererID(other.m_RendererID),
+      m_UniformLocationCache(std::move(other.m_UniformLocationCache))
+{
+    other.m_RendererID = 0;
+}
+
+Shader& Shader::operator=(Shader&& other) noexcept
+{
+    if (this != &other)
+    {
+        glDeleteProgram(m_RendererID);
+        m_FilePath = std::move(other.m_FilePath);
+        m_RendererID = other.m_RendererID;
+        m_UniformLocationCache = std::move(other.m_UniformLocationCache);
+        other.m_RendererID = 0;
+    }
+    return *this;
+}
+
 unsigned int Shader::CompileShader(unsigned int type, const std::string& source){
     unsigned int id = glCreateShader(type);
     const char* src = source.c_str();
@@ -30,25 +57,34 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
 
 ShaderProgramSource Shader::ParseShader (const std::string& filepath){
     std::ifstream stream(filepath);
+    std::stringstream contents;
+    contents << stream.rdbuf();
+    return ParseShader(std::string_view(contents.str()));
+}
+
+ShaderProgramSource Shader::ParseShader (std::string_view source){
     enum class ShaderType{
         NONE= -1, VERTEX = 0, FRAGMENT = 1
     };
-    std::string line;
-    std::stringstream ss[2];
+    std::string ss[2];
     ShaderType type = ShaderType::NONE;
-    while (getline(stream, line)){
-        if(line.find("#shader") != std::string::npos){
-            if(line.find("vertex") != std::string::npos){
+    while (!source.empty()){
+        size_t end = source.find('\n');
+        std::string_view line = source.substr(0, end);
+        source.remove_prefix(end == std::string_view::npos ? source.size() : end + 1);
+
+        if(line.find("#shader") != std::string_view::npos){
+            if(line.find("vertex") != std::string_view::npos){
                 type = ShaderType::VERTEX;
             }
-            else if (line.find("fragment") != std::string::npos){
+            else if (line.find("fragment") != std::string_view::npos){
                 type = ShaderType::FRAGMENT;
             }
-        } else {
-        ss[(int)type] << line << '\n';
+        } else if (type != ShaderType::NONE) {
+        ss[(int)type].append(line.data(), line.size()).push_back('\n');
         }
     }
-    return {ss[0].str(), ss[1].str()};
+    return {ss[0], ss[1]};
 }
 
 unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader){
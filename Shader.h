@@ -1,5 +1,6 @@
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include "glm/glm.hpp"
 
@@ -19,8 +20,15 @@ class Shader{
         std::unordered_map<std::string, int> m_UniformLocationCache;
     public:
         Shader(const std::string& filepath);
+        // builds from in-memory source, e.g. a view into an AssetArchive
+        Shader(const std::string& name, std::string_view source);
         ~Shader();
 
+        Shader(const Shader&) = delete;
+        Shader& operator=(const Shader&) = delete;
+        Shader(Shader&& other) noexcept;
+        Shader& operator=(Shader&& other) noexcept;
+
         void Bind() const;
         void Unbind() const;
 
@@ -30,6 +38,7 @@ class Shader{
         
     private:
         ShaderProgramSource ParseShader (const std::string& filepath);
+        ShaderProgramSource ParseShader (std::string_view source);
         unsigned int CompileShader(unsigned int type, const std::string& source);
         unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
         int GetUniformLocation( const std::string& name);
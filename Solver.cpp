@@ -0,0 +1,401 @@
+#include "Solver.h"
+#include "Board.h"
+
+#include <algorithm>
+#include <bitset>
+
+namespace {
+
+// per cell flags
+const unsigned char s_Safe = 1;
+const unsigned char s_Mine = 2;
+const unsigned char s_Revealed = 4;
+const unsigned char s_Queued = 8;
+const unsigned char s_PairQueued = 16;
+
+// neighbor k; k and 7 - k are opposite
+const int s_NeighborX[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+const int s_NeighborY[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+
+// Partner p is the constraint at (p % 5 - 2, p / 5 - 2) from another, 12
+// being the constraint itself. Cells[p][mask] places the neighbors in mask
+// of partner p in the 7x7 frame around the constraint, bit (y + 3) * 7 +
+// x + 3; Partners[k] are the partners that neighbor k is also adjacent to.
+struct FrameTable
+{
+    uint64_t Cells[25][256];
+    uint32_t Partners[8];
+    unsigned char Sizes[256];   // bits set
+
+    FrameTable()
+    {
+        for (int p = 0; p < 25; p++)
+        {
+            for (int mask = 0; mask < 256; mask++)
+            {
+                uint64_t cells = 0;
+                for (int k = 0; k < 8; k++)
+                    if (mask & (1 << k))
+                        cells |= (uint64_t)1 << ((p / 5 - 2 + s_NeighborY[k] + 3) * 7 + p % 5 - 2 + s_NeighborX[k] + 3);
+                Cells[p][mask] = cells;
+            }
+        }
+        for (int mask = 0; mask < 256; mask++)
+            Sizes[mask] = (unsigned char)std::bitset<8>(mask).count();
+        for (int k = 0; k < 8; k++)
+        {
+            Partners[k] = 0;
+            for (int dy = -1; dy <= 1; dy++)
+                for (int dx = -1; dx <= 1; dx++)
+                    Partners[k] |= (uint32_t)1 << ((s_NeighborY[k] + dy + 2) * 5 + s_NeighborX[k] + dx + 2);
+            Partners[k] &= ~((uint32_t)1 << 12);
+        }
+    }
+};
+
+const FrameTable s_Frames;
+
+inline int LowestBit(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int bit = 0;
+    while (!(word & 1))
+    {
+        word >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+inline int PopCount(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    int count = 0;
+    for (; word; word &= word - 1)
+        count++;
+    return count;
+#endif
+}
+
+inline bool IsRevealedByte(unsigned char cell)
+{
+    return (cell & (Board::STATE_MASK | Board::BORDER_BIT)) == ((int)CellState::REVEALED << Board::STATE_SHIFT);
+}
+
+}
+
+Solver::Solver(Board& board)
+    : m_Board(board), m_BoardBase(board.GetCellData() - board.GetStride() - 1), m_Stride(board.GetStride()),
+      m_SafeCursor(0)
+{
+    for (int k = 0; k < 8; k++)
+        m_Neighbors[k] = (ptrdiff_t)s_NeighborY[k] * (ptrdiff_t)m_Stride + s_NeighborX[k];
+    for (int p = 0; p < 25; p++)
+        m_PartnerOffsets[p] = (ptrdiff_t)(p / 5 - 2) * (ptrdiff_t)m_Stride + p % 5 - 2;
+    for (int f = 0; f < 49; f++)
+        m_FrameOffsets[f] = (ptrdiff_t)(f / 7 - 3) * (ptrdiff_t)m_Stride + f % 7 - 3;
+
+    int width = board.GetWidth(), height = board.GetHeight();
+    m_Cells.assign((size_t)(height + 2) * m_Stride, CellInfo{ s_Safe, 0, 0, 0 });
+
+    // every neighbor starts unknown, except the border
+    for (int y = 0; y < height; y++)
+    {
+        bool edgeRow = y == 0 || y == height - 1;
+        for (int x = 0; x < width; x++)
+        {
+            size_t index = Index(x, y);
+            m_Cells[index].Flags = 0;
+            if (!edgeRow && x != 0 && x != width - 1)
+            {
+                m_Cells[index].Unknown = 0xFF;
+                continue;
+            }
+            unsigned char unknown = 0;
+            for (int k = 0; k < 8; k++)
+                if (!(m_BoardBase[index + m_Neighbors[k]] & Board::BORDER_BIT))
+                    unknown |= (unsigned char)(1 << k);
+            m_Cells[index].Unknown = unknown;
+        }
+    }
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            size_t index = Index(x, y);
+            CellState state = board.GetState(x, y);
+            if (state == CellState::REVEALED)
+                Learn(index);
+            else if (state == CellState::MEME)
+            {
+                m_Cells[index].Flags |= s_Mine;
+                Forget(index, true);
+            }
+        }
+    }
+}
+
+void Solver::Enqueue(size_t index)
+{
+    Enqueue(index, m_Queue.Items.data(), m_Queue.Size, m_PairQueue.Items.data(), m_PairQueue.Size);
+}
+
+inline void Solver::Enqueue(size_t index, size_t* queue, size_t& queued, size_t* pairQueue, size_t& pairQueued)
+{
+    // Constraints the single-cell rule settles are kept apart from the
+    // others, which wait for the pair rule and may no longer need it by the
+    // time it comes up. Whether a cell is revealed and what it is queued for
+    // is close to random here, so the choice is made without branches.
+    CellInfo& cell = m_Cells[index];
+    bool active = ((cell.Flags & s_Revealed) != 0) & (cell.Unknown != 0);
+    bool ready = (cell.Mines == 0) | (cell.Mines == s_Frames.Sizes[cell.Unknown]);
+    bool single = active & ready & !(cell.Flags & s_Queued);
+    bool pair = active & !ready & !(cell.Flags & s_PairQueued);
+    queue[queued] = index;
+    queued += single;
+    pairQueue[pairQueued] = index;
+    pairQueued += pair;
+    cell.Flags |= (unsigned char)((single ? s_Queued : 0) | (pair ? s_PairQueued : 0));
+}
+
+void Solver::Forget(size_t index, bool mine)
+{
+    m_Queue.MakeRoom(8);
+    m_PairQueue.MakeRoom(8);
+    // the stack sizes stay in registers; stores through the item pointers
+    // could otherwise alias them
+    size_t queued = m_Queue.Size, pairQueued = m_PairQueue.Size;
+    size_t* queue = m_Queue.Items.data();
+    size_t* pairQueue = m_PairQueue.Items.data();
+    for (int k = 0; k < 8; k++)
+    {
+        size_t neighbor = index + m_Neighbors[k];
+        CellInfo& cell = m_Cells[neighbor];
+        cell.Unknown &= (unsigned char)~(1 << (7 - k));
+        cell.Mines -= mine;
+        Enqueue(neighbor, queue, queued, pairQueue, pairQueued);
+    }
+    m_Queue.Size = queued;
+    m_PairQueue.Size = pairQueued;
+}
+
+void Solver::Learn(size_t index)
+{
+    CellInfo& cell = m_Cells[index];
+    cell.Flags |= s_Revealed;
+    cell.Mines += m_BoardBase[index] & Board::COUNT_MASK;
+    if (!(cell.Flags & s_Safe))
+    {
+        cell.Flags |= s_Safe;
+        Forget(index, false);
+    }
+    m_Queue.MakeRoom(1);
+    m_PairQueue.MakeRoom(1);
+    Enqueue(index);
+}
+
+void Solver::LearnRegion(size_t start)
+{
+    // a flood's new cells are connected through its new zero cells
+    Learn(start);
+    m_Flood.push_back(start);
+    while (!m_Flood.empty())
+    {
+        size_t index = m_Flood.back();
+        m_Flood.pop_back();
+        if (m_BoardBase[index] & Board::COUNT_MASK)
+            continue;
+        for (int k = 0; k < 8; k++)
+        {
+            size_t neighbor = index + m_Neighbors[k];
+            if (!(m_Cells[neighbor].Flags & s_Revealed) && IsRevealedByte(m_BoardBase[neighbor]))
+            {
+                Learn(neighbor);
+                m_Flood.push_back(neighbor);
+            }
+        }
+    }
+}
+
+void Solver::MarkSafe(size_t index)
+{
+    m_Cells[index].Flags |= s_Safe;
+    m_SafeCells.push_back(index);
+    Forget(index, false);
+}
+
+void Solver::MarkMine(size_t index)
+{
+    m_Cells[index].Flags |= s_Mine;
+    m_MineCells.push_back(index);
+    Forget(index, true);
+}
+
+size_t Solver::Reveal(int x, int y)
+{
+    size_t revealed = m_Board.Reveal(x, y);
+    size_t index = Index(x, y);
+    if (revealed)
+        LearnRegion(index);
+    else if (m_Board.GetState(x, y) == CellState::MEME && !(m_Cells[index].Flags & s_Mine))
+    {
+        m_Cells[index].Flags |= s_Mine;
+        Forget(index, true);
+    }
+    return revealed;
+}
+
+void Solver::ApplyPair(size_t a, size_t b, int partner)
+{
+    uint64_t cellsA = s_Frames.Cells[12][m_Cells[a].Unknown];
+    uint64_t cellsB = s_Frames.Cells[partner][m_Cells[b].Unknown];
+    uint64_t shared = cellsA & cellsB;
+    if (!shared)
+        return;
+    uint64_t onlyA = cellsA & ~cellsB, onlyB = cellsB & ~cellsA;
+    int minesA = m_Cells[a].Mines, minesB = m_Cells[b].Mines;
+    int sizeShared = PopCount(shared), sizeA = PopCount(onlyA), sizeB = PopCount(onlyB);
+
+    // bounds on the mines in the shared cells, from both sides
+    int low = std::max({ 0, minesA - sizeA, minesB - sizeB });
+    int high = std::min({ sizeShared, minesA, minesB });
+
+    // The cells only one side covers hold its mines minus the shared ones.
+    // They are settled when that is all or none of them; the two sets are
+    // not adjacent to the other constraint, so settling one leaves the
+    // other's counts as they were.
+    uint64_t settle[2] = { 0, 0 };
+    bool mines[2] = { false, false };
+    if (sizeA && (minesA - high == sizeA || minesA - low == 0))
+    {
+        settle[0] = onlyA;
+        mines[0] = minesA - high == sizeA;
+    }
+    if (sizeB && (minesB - high == sizeB || minesB - low == 0))
+    {
+        settle[1] = onlyB;
+        mines[1] = minesB - high == sizeB;
+    }
+    for (int side = 0; side < 2; side++)
+    {
+        for (uint64_t frame = settle[side]; frame; frame &= frame - 1)
+        {
+            size_t cell = a + m_FrameOffsets[LowestBit(frame)];
+            if (mines[side])
+                MarkMine(cell);
+            else
+                MarkSafe(cell);
+        }
+    }
+}
+
+size_t Solver::Propagate(bool pairs, bool untilSafe)
+{
+    size_t before = m_SafeCells.size() + m_MineCells.size();
+    size_t safeBefore = m_SafeCells.size();
+    for (;;)
+    {
+        while (!m_Queue.IsEmpty())
+        {
+            size_t a = m_Queue.Pop();
+            m_Cells[a].Flags &= (unsigned char)~s_Queued;
+            SettleAll(a);
+        }
+        if (!pairs || m_PairQueue.IsEmpty() || (untilSafe && m_SafeCells.size() > safeBefore))
+            break;
+
+        size_t a = m_PairQueue.Pop();
+        m_Cells[a].Flags &= (unsigned char)~s_PairQueued;
+        unsigned int unknown = m_Cells[a].Unknown;
+        if (!unknown)
+            continue;
+        if (m_Cells[a].Mines == 0 || m_Cells[a].Mines == s_Frames.Sizes[unknown])
+        {
+            SettleAll(a);
+            continue;
+        }
+
+        // revealed cells sharing an unknown cell with a
+        uint32_t partners = 0;
+        for (unsigned int bits = unknown; bits; bits &= bits - 1)
+            partners |= s_Frames.Partners[LowestBit(bits)];
+        for (; partners && m_Cells[a].Unknown; partners &= partners - 1)
+        {
+            int partner = LowestBit(partners);
+            size_t b = a + m_PartnerOffsets[partner];
+            if ((m_Cells[b].Flags & s_Revealed) && m_Cells[b].Unknown)
+                ApplyPair(a, b, partner);
+        }
+    }
+    return m_SafeCells.size() + m_MineCells.size() - before;
+}
+
+void Solver::SettleAll(size_t a)
+{
+    // every unknown is safe if no mines are left, else every one is a mine
+    unsigned int unknown = m_Cells[a].Unknown;
+    bool mines = m_Cells[a].Mines != 0;
+    for (; unknown; unknown &= unknown - 1)
+    {
+        size_t cell = a + m_Neighbors[LowestBit(unknown)];
+        if (mines)
+            MarkMine(cell);
+        else
+            MarkSafe(cell);
+    }
+}
+
+size_t Solver::Solve()
+{
+    return Propagate(true, false);
+}
+
+bool Solver::GetHint(int& x, int& y)
+{
+    while (m_SafeCursor < m_SafeCells.size() && (m_Cells[m_SafeCells[m_SafeCursor]].Flags & s_Revealed))
+        m_SafeCursor++;
+    if (m_SafeCursor == m_SafeCells.size())
+        return false;
+    x = IndexX(m_SafeCells[m_SafeCursor]);
+    y = IndexY(m_SafeCells[m_SafeCursor]);
+    return true;
+}
+
+bool Solver::Play()
+{
+    // Revealing what the single-cell rule finds is cheaper than the pair
+    // rule, so pairs are only tried once that runs dry, and only until they
+    // turn up a safe cell.
+    int x, y;
+    for (;;)
+    {
+        Propagate(false, false);
+        if (!GetHint(x, y))
+        {
+            Propagate(true, true);
+            if (!GetHint(x, y))
+                return m_Board.IsCleared();
+        }
+        // a safe cell the board will not reveal is flagged by the player, or
+        // the board has exploded; either way play cannot go on from here
+        while (GetHint(x, y))
+            if (Reveal(x, y) == 0)
+                return false;
+    }
+}
+
+bool Solver::IsKnownSafe(int x, int y) const
+{
+    return m_Board.Contains(x, y) && (m_Cells[Index(x, y)].Flags & s_Safe);
+}
+
+bool Solver::IsKnownMine(int x, int y) const
+{
+    return m_Board.Contains(x, y) && (m_Cells[Index(x, y)].Flags & s_Mine);
+}
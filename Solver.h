@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Board;
+
+// Deterministic Minesweeper solver over what a player can see: revealed
+// cells and their counts (flags are the player's guesses and are not
+// trusted; an exploded mine is known). Every revealed cell with unknown
+// neighbors is a constraint -- its unknown neighbors hold its count minus the
+// known mines around it -- stored as an 8-bit mask of its neighbors. Two
+// rules run on them:
+//
+//  - a constraint with no mines left, or as many mines as unknowns, settles
+//    all of its cells;
+//  - two constraints sharing cells are compared in a common 7x7 frame: the
+//    bounds on the mines in their overlap bound the mines in the cells only
+//    one of them covers, which settles those cells when a bound is tight
+//    (this covers the subset and superset reductions).
+//
+// Only constraints touched by a change are re-evaluated: learning a cell
+// queues the revealed cells around it, and a queued constraint is compared
+// with the revealed cells that share one of its unknowns.
+class Solver
+{
+private:
+    Board& m_Board;
+    const unsigned char* m_BoardBase;   // board byte of index 0
+    size_t m_Stride;                    // the board's; index is (y + 1) * stride + x + 1
+    ptrdiff_t m_Neighbors[8];
+    ptrdiff_t m_PartnerOffsets[25];     // 5x5 around a constraint
+    ptrdiff_t m_FrameOffsets[49];       // 7x7 around a constraint
+
+    // everything the rules read about a cell, in one place
+    struct CellInfo
+    {
+        unsigned char Flags;
+        unsigned char Unknown;  // unknown neighbors, bit k for m_Neighbors[k]
+        signed char Mines;      // count minus known adjacent mines once revealed
+        unsigned char Padding;
+    };
+
+    // Stack of cell indices with room made ahead of time, so a push can
+    // always write and only count itself when wanted (see Enqueue).
+    struct IndexStack
+    {
+        std::vector<size_t> Items;
+        size_t Size = 0;
+
+        inline void MakeRoom(size_t count)
+        {
+            if (Size + count > Items.size())
+                Items.resize(2 * Items.size() + count + 1024);
+        }
+        inline bool IsEmpty() const { return Size == 0; }
+        inline size_t Pop() { return Items[--Size]; }
+    };
+
+    std::vector<CellInfo> m_Cells;
+    IndexStack m_Queue;         // constraints the single-cell rule settles
+    IndexStack m_PairQueue;     // constraints waiting for the pair rule
+    std::vector<size_t> m_Flood;
+    std::vector<size_t> m_SafeCells;    // deduced, in order
+    std::vector<size_t> m_MineCells;
+    size_t m_SafeCursor;                // m_SafeCells before it are revealed
+
+    inline size_t Index(int x, int y) const { return (size_t)(y + 1) * m_Stride + (size_t)(x + 1); }
+    inline int IndexX(size_t index) const { return (int)(index % m_Stride) - 1; }
+    inline int IndexY(size_t index) const { return (int)(index / m_Stride) - 1; }
+
+    // queues a revealed cell with unknowns on the queue its rule needs;
+    // room for the push must have been made
+    void Enqueue(size_t index);
+    void Enqueue(size_t index, size_t* queue, size_t& queued, size_t* pairQueue, size_t& pairQueued);
+    // the cell is no longer unknown to its neighbors
+    void Forget(size_t index, bool mine);
+    void Learn(size_t index);
+    void LearnRegion(size_t start);
+    void MarkSafe(size_t index);
+    void MarkMine(size_t index);
+    void ApplyPair(size_t a, size_t b, int partner);
+    // settles a constraint the single-cell rule applies to
+    void SettleAll(size_t a);
+    // the single-cell rule until nothing is queued, then the pair rule too
+    // if pairs is set, stopping early once a safe cell is found if untilSafe is
+    size_t Propagate(bool pairs, bool untilSafe);
+public:
+    // reads the board's revealed cells and exploded mine
+    explicit Solver(Board& board);
+
+    Solver(const Solver&) = delete;
+    Solver& operator=(const Solver&) = delete;
+
+    // Board::Reveal, learning every cell it revealed
+    size_t Reveal(int x, int y);
+
+    // Propagates until no queued constraint yields anything and returns the
+    // number of cells settled.
+    size_t Solve();
+    // Solves and reveals the safe cells found, until no more are found or
+    // one cannot be revealed (a wrong flag on it, or an explosion); true if
+    // the board ends up cleared.
+    bool Play();
+
+    // a deduced safe cell that is not revealed yet, for hints; a flagged one
+    // points out a wrong flag
+    bool GetHint(int& x, int& y);
+
+    bool IsKnownSafe(int x, int y) const;
+    bool IsKnownMine(int x, int y) const;
+    inline size_t GetSafeCount() const { return m_SafeCells.size(); }
+    inline size_t GetMineCount() const { return m_MineCells.size(); }
+};
@@ -1,40 +1,317 @@
 #include "Texture.h"
+#include "TextureCache.h"
 #include "stb_image.h"
+#include "GpuMemory.h"
 
-Texture::Texture(const std::string &path) : 
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+
+namespace {
+
+int MipLevelCount(int width, int height)
+{
+    int levels = 1;
+    for (int size = std::max(width, height); size > 1; size >>= 1)
+        levels++;
+    return levels;
+}
+
+// 2x2 box filter down to 1x1; odd edges reuse their last row/column
+std::vector<std::vector<unsigned char>> BuildMipChain(std::vector<unsigned char> base, int width, int height, int levels)
+{
+    std::vector<std::vector<unsigned char>> chain;
+    chain.reserve(levels);
+    chain.push_back(std::move(base));
+
+    for (int level = 1; level < levels; level++)
+    {
+        const std::vector<unsigned char>& src = chain.back();
+        int srcWidth = width, srcHeight = height;
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+
+        std::vector<unsigned char> dst((size_t)width * height * 4);
+        for (int y = 0; y < height; y++)
+        {
+            const unsigned char* row0 = src.data() + (size_t)std::min(2 * y, srcHeight - 1) * srcWidth * 4;
+            const unsigned char* row1 = src.data() + (size_t)std::min(2 * y + 1, srcHeight - 1) * srcWidth * 4;
+            for (int x = 0; x < width; x++)
+            {
+                int x0 = std::min(2 * x, srcWidth - 1) * 4;
+                int x1 = std::min(2 * x + 1, srcWidth - 1) * 4;
+                for (int c = 0; c < 4; c++)
+                    dst[((size_t)y * width + x) * 4 + c] =
+                        (unsigned char)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+            }
+        }
+        chain.push_back(std::move(dst));
+    }
+    return chain;
+}
+
+}
+
+Texture::Texture(const std::string &path, const TextureOptions &options) : 
 m_RendererID(0), m_FilePath(path), 
-m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0)
+m_Width(0), m_Height(0), m_BPP(0), m_Levels(1), m_AllocationID(0), m_Options(options)
 {
+    // decoded pixels come mapped from the on-disk cache when it is warm
+    CachedImage image = TextureCache::Get().Load(path);
+    m_Width = image.GetWidth();
+    m_Height = image.GetHeight();
+    m_BPP = 4;
+
+    Upload(image.GetPixels());
+}
+
+Texture::Texture(const std::string &name, const AssetView &asset, const TextureOptions &options) :
+m_RendererID(0), m_FilePath(name),
+m_Width(0), m_Height(0), m_BPP(0), m_Levels(1), m_AllocationID(0), m_Options(options)
+{
+    if (asset.Encoding == AssetEncoding::RGBA8)
+    {
+        // pre-decoded in the archive: upload straight from the mapping
+        m_Width = asset.Width;
+        m_Height = asset.Height;
+        m_BPP = 4;
+        Upload(asset.Data);
+        return;
+    }
+
+    if (asset.Size > INT_MAX)
+    {
+        // stb_image takes an int length; left without storage, like a failed decode
+        m_Width = m_Height = 0;
+        Upload(nullptr);
+        return;
+    }
+
     stbi_set_flip_vertically_on_load(1);
-    m_LocalBuffer = stbi_load(path.c_str(), &m_Width, &m_Height, &m_BPP, 4);
+
+    int width, height, channels;
+    if (m_Options.Mipmaps != MipmapMode::BACKGROUND
+        && stbi_info_from_memory(asset.Data, (int)asset.Size, &width, &height, &channels))
+    {
+        // decode bottom-up rows straight into a mapped unpack buffer; the
+        // background mip builder needs CPU pixels, so it takes the path below
+        PixelUnpackBuffer staging((unsigned int)width * height * 4);
+        unsigned char* mapped = static_cast<unsigned char*>(staging.Map());
+        bool decoded = mapped && stbi_load_from_memory_into(asset.Data, (int)asset.Size, mapped, staging.GetSize(),
+                                                            &m_Width, &m_Height, &m_BPP, 4);
+        if (staging.Unmap() && decoded)
+        {
+            Upload(nullptr);
+            SetData(staging, 0, 0, 0, m_Width, m_Height);
+            if (m_Options.Mipmaps == MipmapMode::GPU)
+                GenerateMipmaps();
+            return;
+        }
+    }
+
+    unsigned char* pixels = stbi_load_from_memory(asset.Data, (int)asset.Size, &m_Width, &m_Height, &m_BPP, 4);
+    if (!pixels)
+        m_Width = m_Height = 0;     // a failed attempt above may have set them
+    Upload(pixels);
+    if (pixels)
+        stbi_image_free(pixels);
+}
+
+Texture::Texture(int width, int height, const TextureOptions &options) :
+m_RendererID(0), m_FilePath(),
+m_Width(width), m_Height(height), m_BPP(4), m_Levels(1), m_AllocationID(0), m_Options(options)
+{
+    Upload(nullptr);
+}
+
+void Texture::Upload(const unsigned char* pixels)
+{
+    if (m_Width <= 0 || m_Height <= 0)
+    {
+        // nothing decoded: no GL texture, no storage, and IsValid() says so
+        m_Width = m_Height = m_BPP = 0;
+        m_Levels = 0;
+        return;
+    }
+    m_Levels = m_Options.Mipmaps == MipmapMode::NONE ? 1 : MipLevelCount(m_Width, m_Height);
 
     glGenTextures(1, &m_RendererID);
     glBindTexture(GL_TEXTURE_2D, m_RendererID);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer);
+    if (GLAD_GL_VERSION_4_2)
+    {
+        // immutable storage: the driver can validate and place it once
+        glTexStorage2D(GL_TEXTURE_2D, m_Levels, GL_RGBA8, m_Width, m_Height);
+        if (pixels)
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    }
+    else
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        for (int level = 1; level < m_Levels; level++)
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, std::max(1, m_Width >> level), std::max(1, m_Height >> level),
+                         0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+
+    if (m_Options.Mipmaps == MipmapMode::BACKGROUND && pixels)
+    {
+        // sample level 0 only until the chain arrives
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        std::vector<unsigned char> base(pixels, pixels + (size_t)m_Width * m_Height * 4);
+        m_PendingMipmaps = std::async(std::launch::async, BuildMipChain, std::move(base), m_Width, m_Height, m_Levels);
+    }
+    else
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_Levels - 1);
+        if (m_Options.Mipmaps != MipmapMode::NONE && pixels)
+            glGenerateMipmap(GL_TEXTURE_2D);
+    }
+
+    ApplyFilter();
     glBindTexture(GL_TEXTURE_2D, 0);
 
-    if(m_LocalBuffer)
-        stbi_image_free(m_LocalBuffer);
+    m_AllocationID = GpuMemory::Get().Register(GpuResourceCategory::TEXTURE, GetSizeInBytes());
+    GpuMemory::Get().EnforceBudget();
+}
+
+size_t Texture::GetSizeInBytes() const
+{
+    size_t bytes = 0;
+    for (int level = 0; level < m_Levels; level++)
+        bytes += (size_t)std::max(1, m_Width >> level) * std::max(1, m_Height >> level) * 4;
+    return bytes;
+}
+
+void Texture::ApplyFilter() const
+{
+    bool linear = m_Options.Filter == TextureFilter::LINEAR;
+    GLint minFilter = linear ? GL_LINEAR : GL_NEAREST;
+    if (m_Levels > 1)
+        minFilter = linear ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, linear ? GL_LINEAR : GL_NEAREST);
 }
 
 Texture::~Texture()
 {
     glDeleteTextures(1, &m_RendererID);
+    GpuMemory::Get().Unregister(m_AllocationID);
+}
+
+Texture::Texture(Texture&& other) noexcept
+    : m_RendererID(other.m_RendererID), m_FilePath(std::move(other.m_FilePath)),
+      m_Width(other.m_Width), m_Height(other.m_Height), m_BPP(other.m_BPP),
+      m_Levels(other.m_Levels), m_AllocationID(other.m_AllocationID), m_Options(other.m_Options),
+      m_PendingMipmaps(std::move(other.m_PendingMipmaps))
+{
+    other.m_RendererID = 0;
+    other.m_AllocationID = 0;
+    other.m_Width = other.m_Height = other.m_BPP = 0;
+}
+
+Texture& Texture::operator=(Texture&& other) noexcept
+{
+    if (this != &other)
+    {
+        glDeleteTextures(1, &m_RendererID);
+        GpuMemory::Get().Unregister(m_AllocationID);
+        m_RendererID = other.m_RendererID;
+        m_FilePath = std::move(other.m_FilePath);
+        m_Width = other.m_Width;
+        m_Height = other.m_Height;
+        m_BPP = other.m_BPP;
+        m_Levels = other.m_Levels;
+        m_AllocationID = other.m_AllocationID;
+        other.m_AllocationID = 0;
+        m_Options = other.m_Options;
+        m_PendingMipmaps = std::move(other.m_PendingMipmaps);
+        other.m_RendererID = 0;
+        other.m_Width = other.m_Height = other.m_BPP = 0;
+    }
+    return *this;
 }
 
 void Texture::Bind(unsigned int slot) const
 {
     glActiveTexture(GL_TEXTURE0 + slot);
     glBindTexture(GL_TEXTURE_2D, m_RendererID);
+    GpuMemory::Get().Touch(m_AllocationID);
 }
 
 void Texture::Unbind() const
 {
      glBindTexture(GL_TEXTURE_2D, 0);
 }
+
+void Texture::SetData(const unsigned char *pixels, int x, int y, int width, int height, int rowLength)
+{
+    if (!IsValid())
+        return;
+    glBindTexture(GL_TEXTURE_2D, m_RendererID);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, rowLength);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Texture::SetData(const PixelUnpackBuffer &buffer, unsigned int offset, int x, int y, int width, int height, int rowLength)
+{
+    // with an unpack buffer bound the pointer argument is an offset into it
+    buffer.Bind();
+    SetData(reinterpret_cast<const unsigned char*>((uintptr_t)offset), x, y, width, height, rowLength);
+    buffer.Unbind();
+}
+
+void Texture::SetFilter(TextureFilter filter)
+{
+    m_Options.Filter = filter;
+    if (!IsValid())
+        return;
+    glBindTexture(GL_TEXTURE_2D, m_RendererID);
+    ApplyFilter();
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Texture::GenerateMipmaps()
+{
+    if (m_Levels < 2)
+        return;
+    glBindTexture(GL_TEXTURE_2D, m_RendererID);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+bool Texture::PollMipmaps()
+{
+    if (!m_PendingMipmaps.valid())
+        return true;
+    if (m_PendingMipmaps.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return false;
+
+    std::vector<std::vector<unsigned char>> chain = m_PendingMipmaps.get();
+    glBindTexture(GL_TEXTURE_2D, m_RendererID);
+    for (int level = 1; level < (int)chain.size(); level++)
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, std::max(1, m_Width >> level), std::max(1, m_Height >> level),
+                        GL_RGBA, GL_UNSIGNED_BYTE, chain[level].data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_Levels - 1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+TextureRegion Texture::GetRegion(int x, int y, int width, int height) const
+{
+    if (m_Width == 0 || m_Height == 0)
+        return { 0.0f, 0.0f, 1.0f, 1.0f };
+
+    // rows were flipped on upload, so the image top is v = 1
+    float u0 = (float)x / m_Width;
+    float u1 = (float)(x + width) / m_Width;
+    float v0 = (float)(m_Height - y - height) / m_Height;
+    float v1 = (float)(m_Height - y) / m_Height;
+    return { u0, v0, u1, v1 };
+}
@@ -1,23 +1,85 @@
 #pragma once
 
 #include "Renderer.h"
+#include "AssetArchive.h"
+#include "PixelUnpackBuffer.h"
+
+#include <future>
+#include <vector>
+
+// UV rectangle of a sub-image, bottom-left origin as sampled by the shader
+struct TextureRegion
+{
+    float U0, V0, U1, V1;
+};
+
+enum class TextureFilter
+{
+    NEAREST = 0, LINEAR = 1
+};
+
+enum class MipmapMode
+{
+    NONE = 0,       // single level
+    GPU = 1,        // glGenerateMipmap right after the upload
+    BACKGROUND = 2  // box-filtered on a worker thread, uploaded by PollMipmaps()
+};
+
+struct TextureOptions
+{
+    TextureFilter Filter = TextureFilter::LINEAR;
+    MipmapMode Mipmaps = MipmapMode::NONE;
+};
 
 class Texture
 {
 private:
     unsigned int m_RendererID;
     std::string m_FilePath;
-    unsigned char* m_LocalBuffer;
     int m_Width, m_Height, m_BPP;
+    int m_Levels;
+    unsigned int m_AllocationID;
+    TextureOptions m_Options;
+    std::future<std::vector<std::vector<unsigned char>>> m_PendingMipmaps;
+
+    void Upload(const unsigned char* pixels);
+    void ApplyFilter() const;
 public:
-    Texture(const std::string& path);
+    Texture(const std::string& path, const TextureOptions& options = TextureOptions());
+    Texture(const std::string& name, const AssetView& asset, const TextureOptions& options = TextureOptions());
+    // empty RGBA8 texture for contents updated in place with SetData
+    Texture(int width, int height, const TextureOptions& options = TextureOptions());
     ~Texture();
 
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
+    Texture(Texture&& other) noexcept;
+    Texture& operator=(Texture&& other) noexcept;
+
     void Bind(unsigned int slot = 0) const;
     void Unbind() const;
 
+    // Replaces a region of level 0 with tightly packed RGBA8 rows, or rows
+    // rowLength pixels apart. Mipmaps are not refreshed; call GenerateMipmaps.
+    void SetData(const unsigned char* pixels, int x, int y, int width, int height, int rowLength = 0);
+    void SetData(const PixelUnpackBuffer& buffer, unsigned int offset, int x, int y, int width, int height, int rowLength = 0);
+
+    void SetFilter(TextureFilter filter);
+    void GenerateMipmaps();
+    // Uploads a finished background mip chain; returns true once it is in place.
+    bool PollMipmaps();
+
+    // false when the image could not be decoded; such a texture has no storage
+    inline bool IsValid() const { return m_RendererID != 0; }
     inline int GetWidth() const { return m_Width; } 
     inline int GetHeight() const { return m_Height; }
-};
-
+    inline int GetLevels() const { return m_Levels; }
+    size_t GetSizeInBytes() const;
+    inline const std::string& GetFilePath() const { return m_FilePath; }
+    // GpuMemory id, as passed to its eviction handler
+    inline unsigned int GetAllocationID() const { return m_AllocationID; }
 
+    // x, y are measured from the top-left of the source image, the way image
+    // editors and the atlas packer report them
+    TextureRegion GetRegion(int x, int y, int width, int height) const;
+};
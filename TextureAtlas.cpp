@@ -0,0 +1,22 @@
+#include "TextureAtlas.h"
+
+TextureAtlas::TextureAtlas(const std::string &imagePath, const AtlasSprite *sprites, unsigned int count)
+    : m_Texture(imagePath)
+{
+    m_Regions.reserve(count);
+    for (unsigned int i = 0; i < count; i++)
+        m_Regions[sprites[i].Name] = sprites[i].Region;
+}
+
+TextureRegion TextureAtlas::Find(std::string_view name) const
+{
+    auto it = m_Regions.find(name);
+    if (it == m_Regions.end())
+        return { 0.0f, 0.0f, 1.0f, 1.0f };
+    return it->second;
+}
+
+bool TextureAtlas::Contains(std::string_view name) const
+{
+    return m_Regions.find(name) != m_Regions.end();
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Texture.h"
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Pixel rectangle of one sprite in an atlas image (top-left origin, as in the
+// image file) with its UV rectangle already converted for the flipped upload.
+struct AtlasSprite
+{
+    const char* Name;
+    int X, Y, Width, Height;
+    TextureRegion Region;
+};
+
+// One texture holding many sprites, as produced by tools/atlas_pack.cpp. The
+// sprite table is the generated header emitted next to the atlas image.
+class TextureAtlas
+{
+private:
+    Texture m_Texture;
+    std::unordered_map<std::string_view, TextureRegion> m_Regions;
+public:
+    TextureAtlas(const std::string& imagePath, const AtlasSprite* sprites, unsigned int count);
+
+    // returns the full texture when the sprite is unknown
+    TextureRegion Find(std::string_view name) const;
+    bool Contains(std::string_view name) const;
+
+    inline const Texture& GetTexture() const { return m_Texture; }
+    inline void Bind(unsigned int slot = 0) const { m_Texture.Bind(slot); }
+};
@@ -0,0 +1,262 @@
+#include "TextureCache.h"
+#include "ImageLoader.h"
+#include "stb_image.h"
+
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char s_Magic[8] = { 'T', 'E', 'X', 'C', 'A', 'C', 'H', 'E' };
+const uint32_t s_Version = 1;
+const uint32_t s_PageSize = 4096;
+
+struct TextureCacheHeader
+{
+    char Magic[8];
+    uint32_t Version;
+    uint32_t DataOffset;
+    uint32_t Width;
+    uint32_t Height;
+    uint64_t SourceSize;
+    int64_t SourceMtime;
+    uint64_t ContentHash;
+    uint64_t DataSize;
+};
+
+double ElapsedMilliseconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+CachedImage::CachedImage()
+    : m_Decoded(nullptr), m_Pixels(nullptr), m_Width(0), m_Height(0), m_FromCache(false)
+{
+}
+
+CachedImage::~CachedImage()
+{
+    if (m_Decoded)
+        stbi_image_free(m_Decoded);
+}
+
+CachedImage::CachedImage(CachedImage&& other) noexcept
+    : m_Mapping(std::move(other.m_Mapping)), m_Decoded(other.m_Decoded), m_Pixels(other.m_Pixels),
+      m_Width(other.m_Width), m_Height(other.m_Height), m_FromCache(other.m_FromCache)
+{
+    other.m_Decoded = nullptr;
+    other.m_Pixels = nullptr;
+    other.m_Width = other.m_Height = 0;
+}
+
+CachedImage& CachedImage::operator=(CachedImage&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (m_Decoded)
+            stbi_image_free(m_Decoded);
+        m_Mapping = std::move(other.m_Mapping);
+        m_Decoded = other.m_Decoded;
+        m_Pixels = other.m_Pixels;
+        m_Width = other.m_Width;
+        m_Height = other.m_Height;
+        m_FromCache = other.m_FromCache;
+        other.m_Decoded = nullptr;
+        other.m_Pixels = nullptr;
+        other.m_Width = other.m_Height = 0;
+    }
+    return *this;
+}
+
+TextureCache::TextureCache()
+    : m_Directory(".texcache"), m_Enabled(true)
+{
+}
+
+TextureCache& TextureCache::Get()
+{
+    static TextureCache cache;
+    return cache;
+}
+
+void TextureCache::SetDirectory(const std::string &directory)
+{
+    m_Directory = directory;
+}
+
+uint64_t TextureCache::Hash(const unsigned char *data, size_t size, uint64_t seed)
+{
+    // FNV-1a
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string TextureCache::GetEntryPath(const std::string &path) const
+{
+    uint64_t key = Hash(reinterpret_cast<const unsigned char*>(path.data()), path.size());
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.rgba", (unsigned long long)key);
+    return m_Directory + "/" + name;
+}
+
+CachedImage TextureCache::Load(const std::string &path)
+{
+    auto start = std::chrono::steady_clock::now();
+    CachedImage image;
+
+    struct stat st;
+    bool haveSource = stat(path.c_str(), &st) == 0;
+    uint64_t sourceSize = haveSource ? (uint64_t)st.st_size : 0;
+    int64_t sourceMtime = haveSource ? (int64_t)st.st_mtim.tv_sec * 1000000000ll + st.st_mtim.tv_nsec : 0;
+    std::string entryPath = GetEntryPath(path);
+
+    if (m_Enabled && haveSource)
+    {
+        MappedFile entry(entryPath);
+        const TextureCacheHeader* header = reinterpret_cast<const TextureCacheHeader*>(entry.GetData());
+        bool valid = entry.IsOpen() && entry.GetSize() >= sizeof(TextureCacheHeader)
+            && std::memcmp(header->Magic, s_Magic, sizeof(s_Magic)) == 0
+            && header->Version == s_Version
+            && header->SourceSize == sourceSize
+            && header->DataSize == (uint64_t)header->Width * header->Height * 4
+            && header->DataOffset + header->DataSize <= entry.GetSize();
+
+        if (valid && header->SourceMtime != sourceMtime)
+        {
+            // touched but possibly unchanged (checkout, copy): compare content
+            MappedFile source(path, FileAccess::SEQUENTIAL);
+            valid = source.IsOpen() && Hash(source.GetData(), source.GetSize()) == header->ContentHash;
+            if (valid)
+            {
+                int fd = open(entryPath.c_str(), O_WRONLY | O_CLOEXEC);
+                if (fd >= 0)
+                {
+                    pwrite(fd, &sourceMtime, sizeof(sourceMtime), offsetof(TextureCacheHeader, SourceMtime));
+                    close(fd);
+                }
+            }
+        }
+
+        if (valid)
+        {
+            Adopt(image, std::move(entry));
+            image.m_FromCache = true;
+
+            m_Stats.Hits++;
+            m_Stats.HitMilliseconds += ElapsedMilliseconds(start);
+            return image;
+        }
+    }
+
+    if (m_Enabled && haveSource)
+    {
+        // decode straight into a new entry and serve this load from its mapping;
+        // stb_image takes an int length, so a larger source is left to
+        // ImageLoader below to reject
+        MappedFile source(path, FileAccess::SEQUENTIAL);
+        if (source.IsOpen() && source.GetSize() <= INT_MAX && Store(entryPath, source, sourceSize, sourceMtime))
+        {
+            MappedFile entry(entryPath);
+            if (entry.IsOpen() && entry.GetSize() >= s_PageSize)
+            {
+                Adopt(image, std::move(entry));
+                m_Stats.Misses++;
+                m_Stats.MissMilliseconds += ElapsedMilliseconds(start);
+                return image;
+            }
+        }
+    }
+
+    int bpp = 0;
+    stbi_set_flip_vertically_on_load(1);
+    image.m_Decoded = ImageLoader::Load(path, &image.m_Width, &image.m_Height, &bpp, 4);
+    image.m_Pixels = image.m_Decoded;
+    if (!image.m_Decoded)
+    {
+        std::cout << "failed to load texture " << path << ": " << ImageLoader::GetFailureReason() << std::endl;
+        image.m_Width = image.m_Height = 0;
+    }
+
+    m_Stats.Misses++;
+    m_Stats.MissMilliseconds += ElapsedMilliseconds(start);
+    return image;
+}
+
+void TextureCache::Adopt(CachedImage &image, MappedFile &&entry)
+{
+    const TextureCacheHeader* header = reinterpret_cast<const TextureCacheHeader*>(entry.GetData());
+    image.m_Width = (int)header->Width;
+    image.m_Height = (int)header->Height;
+    image.m_Pixels = entry.GetData() + header->DataOffset;
+    image.m_Mapping = std::move(entry);
+}
+
+bool TextureCache::Store(const std::string &entryPath, const MappedFile &source,
+                         uint64_t sourceSize, int64_t sourceMtime) const
+{
+    int width, height, channels;
+    if (!stbi_info_from_memory(source.GetData(), (int)source.GetSize(), &width, &height, &channels))
+        return false;
+
+    mkdir(m_Directory.c_str(), 0755);
+
+    TextureCacheHeader header;
+    std::memcpy(header.Magic, s_Magic, sizeof(s_Magic));
+    header.Version = s_Version;
+    header.DataOffset = s_PageSize;
+    header.Width = (uint32_t)width;
+    header.Height = (uint32_t)height;
+    header.SourceSize = sourceSize;
+    header.SourceMtime = sourceMtime;
+    header.ContentHash = Hash(source.GetData(), source.GetSize());
+    header.DataSize = (uint64_t)width * height * 4;
+
+    // write aside and rename so a concurrent reader never maps a partial entry
+    std::string tempPath = entryPath + ".tmp." + std::to_string(getpid());
+    int fd = open(tempPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return false;
+
+    // the decoder writes its bottom-up rows directly into the entry's pages
+    size_t fileSize = s_PageSize + header.DataSize;
+    bool ok = ftruncate(fd, (off_t)fileSize) == 0;
+    void* mapping = ok ? mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ok = mapping != MAP_FAILED;
+    if (ok)
+    {
+        unsigned char* bytes = static_cast<unsigned char*>(mapping);
+        std::memcpy(bytes, &header, sizeof(header));
+        stbi_set_flip_vertically_on_load(1);
+        ok = stbi_load_from_memory_into(source.GetData(), (int)source.GetSize(), bytes + s_PageSize, header.DataSize,
+                                        &width, &height, &channels, 4) != nullptr;
+        munmap(mapping, fileSize);
+    }
+    ok = close(fd) == 0 && ok;
+    if (ok)
+        ok = rename(tempPath.c_str(), entryPath.c_str()) == 0;
+    if (!ok)
+        unlink(tempPath.c_str());
+    return ok;
+}
+
+void TextureCache::PrintStats() const
+{
+    std::cout << "texture cache: " << m_Stats.Hits << " warm (" << m_Stats.HitMilliseconds << " ms), "
+              << m_Stats.Misses << " cold (" << m_Stats.MissMilliseconds << " ms)" << std::endl;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <string>
+
+// Decoded RGBA8 pixels, either mapped straight from a cache file or owned
+// from a fresh decode. Rows are stored bottom-up, ready for glTexImage2D.
+class CachedImage
+{
+private:
+    MappedFile m_Mapping;
+    unsigned char* m_Decoded;
+    const unsigned char* m_Pixels;
+    int m_Width, m_Height;
+    bool m_FromCache;
+
+    friend class TextureCache;
+public:
+    CachedImage();
+    ~CachedImage();
+
+    CachedImage(const CachedImage&) = delete;
+    CachedImage& operator=(const CachedImage&) = delete;
+    CachedImage(CachedImage&& other) noexcept;
+    CachedImage& operator=(CachedImage&& other) noexcept;
+
+    inline const unsigned char* GetPixels() const { return m_Pixels; }
+    inline int GetWidth() const { return m_Width; }
+    inline int GetHeight() const { return m_Height; }
+    inline bool IsFromCache() const { return m_FromCache; }
+};
+
+struct TextureCacheStats
+{
+    unsigned int Hits = 0;
+    unsigned int Misses = 0;
+    double HitMilliseconds = 0.0;
+    double MissMilliseconds = 0.0;
+};
+
+// On-disk cache of decoded textures. An entry is keyed by the source path and
+// validated against the source size and mtime; when only the mtime changed the
+// source content hash decides. Payloads start on a page boundary so a warm load
+// is one mmap with no decode and no copy.
+class TextureCache
+{
+private:
+    std::string m_Directory;
+    bool m_Enabled;
+    TextureCacheStats m_Stats;
+
+    TextureCache();
+
+    std::string GetEntryPath(const std::string& path) const;
+    // decodes the source into a new entry file through a writable mapping
+    bool Store(const std::string& entryPath, const MappedFile& source,
+               uint64_t sourceSize, int64_t sourceMtime) const;
+    static void Adopt(CachedImage& image, MappedFile&& entry);
+public:
+    static TextureCache& Get();
+
+    CachedImage Load(const std::string& path);
+
+    void SetDirectory(const std::string& directory);
+    inline void SetEnabled(bool enabled) { m_Enabled = enabled; }
+
+    inline const TextureCacheStats& GetStats() const { return m_Stats; }
+    void PrintStats() const;
+
+    static uint64_t Hash(const unsigned char* data, size_t size, uint64_t seed = 14695981039346656037ull);
+};
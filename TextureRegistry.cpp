@@ -0,0 +1,76 @@
+#include "TextureRegistry.h"
+
+TextureRegistry::TextureRegistry(const AssetArchive* archive)
+    : m_Archive(archive)
+{
+    GpuMemory& memory = GpuMemory::Get();
+    m_PreviousHandler = memory.GetEvictionHandler();
+    memory.SetEvictionHandler([this](unsigned int id, GpuResourceCategory category, size_t bytes) {
+        return Evict(id, category, bytes);
+    });
+}
+
+TextureRegistry::~TextureRegistry()
+{
+    GpuMemory::Get().SetEvictionHandler(std::move(m_PreviousHandler));
+}
+
+std::shared_ptr<Texture> TextureRegistry::Acquire(const std::string &path)
+{
+    std::shared_ptr<Texture>& slot = m_Textures[path];
+    if (slot)
+        return slot;
+
+    AssetView asset = m_Archive ? m_Archive->Find(path) : AssetView();
+    std::shared_ptr<Texture> texture = asset.IsValid()
+        ? std::make_shared<Texture>(path, asset)
+        : std::make_shared<Texture>(path);
+    slot = texture;
+    return texture;
+}
+
+bool TextureRegistry::Evict(unsigned int id, GpuResourceCategory category, size_t bytes)
+{
+    if (category == GpuResourceCategory::TEXTURE)
+    {
+        for (auto& entry : m_Textures)
+        {
+            if (!entry.second || entry.second->GetAllocationID() != id)
+                continue;
+            if (entry.second.use_count() > 1)
+                return false;
+            // destroying it unregisters the allocation right away
+            entry.second.reset();
+            return true;
+        }
+    }
+    return m_PreviousHandler && m_PreviousHandler(id, category, bytes);
+}
+
+void TextureRegistry::Prune()
+{
+    for (auto it = m_Textures.begin(); it != m_Textures.end(); )
+    {
+        if (!it->second || it->second.use_count() == 1)
+            it = m_Textures.erase(it);
+        else
+            ++it;
+    }
+}
+
+unsigned int TextureRegistry::GetLiveCount() const
+{
+    unsigned int count = 0;
+    for (const auto& entry : m_Textures)
+        if (entry.second.use_count() > 1)
+            count++;
+    return count;
+}
+
+long TextureRegistry::GetUseCount(const std::string &path) const
+{
+    auto it = m_Textures.find(path);
+    if (it == m_Textures.end() || !it->second)
+        return 0;
+    return it->second.use_count() - 1;
+}
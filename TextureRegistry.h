@@ -0,0 +1,40 @@
+#pragma once
+
+#include "GpuMemory.h"
+#include "Texture.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Path-keyed cache of textures. Each image is decoded and uploaded at most once
+// while it stays cached; paths found in the archive, if any, are loaded from
+// it. A texture outlives its last handle in the cache, so it can be handed out
+// again without a reload, until Prune() or the GPU memory budget evicts it:
+// the registry is GpuMemory's eviction handler while it exists, releasing the
+// least recently bound textures nobody else holds and passing every other
+// allocation on to the handler installed before it.
+class TextureRegistry
+{
+private:
+    std::unordered_map<std::string, std::shared_ptr<Texture>> m_Textures;
+    const AssetArchive* m_Archive;
+    GpuMemory::EvictionHandler m_PreviousHandler;
+
+    bool Evict(unsigned int id, GpuResourceCategory category, size_t bytes);
+public:
+    explicit TextureRegistry(const AssetArchive* archive = nullptr);
+    ~TextureRegistry();
+
+    TextureRegistry(const TextureRegistry&) = delete;
+    TextureRegistry& operator=(const TextureRegistry&) = delete;
+
+    std::shared_ptr<Texture> Acquire(const std::string& path);
+
+    // Releases the cached textures without a handle outside the registry.
+    void Prune();
+
+    // textures with a handle outside the registry
+    unsigned int GetLiveCount() const;
+    long GetUseCount(const std::string& path) const;
+};
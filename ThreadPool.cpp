@@ -0,0 +1,60 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned int threads)
+    : m_Running(0), m_Stopping(false)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    m_Workers.reserve(threads);
+    for (unsigned int i = 0; i < threads; i++)
+        m_Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    Wait();
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_TaskAvailable.notify_all();
+    for (std::thread& worker : m_Workers)
+        worker.join();
+}
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Tasks.push_back(std::move(task));
+    }
+    m_TaskAvailable.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Idle.wait(lock, [this] { return m_Tasks.empty() && m_Running == 0; });
+}
+
+void ThreadPool::WorkerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (true)
+    {
+        m_TaskAvailable.wait(lock, [this] { return m_Stopping || !m_Tasks.empty(); });
+        if (m_Tasks.empty())
+            return;
+
+        std::function<void()> task = std::move(m_Tasks.front());
+        m_Tasks.pop_front();
+        m_Running++;
+        lock.unlock();
+        task();
+        lock.lock();
+        if (--m_Running == 0 && m_Tasks.empty())
+            m_Idle.notify_all();
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads draining a FIFO of tasks. Wait() blocks until
+// every task submitted so far has finished; the destructor waits as well.
+class ThreadPool
+{
+private:
+    std::vector<std::thread> m_Workers;
+    std::deque<std::function<void()>> m_Tasks;
+    std::mutex m_Mutex;
+    std::condition_variable m_TaskAvailable;
+    std::condition_variable m_Idle;
+    unsigned int m_Running;
+    bool m_Stopping;
+
+    void WorkerLoop();
+public:
+    // 0 uses one thread per hardware thread
+    explicit ThreadPool(unsigned int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void Submit(std::function<void()> task);
+    void Wait();
+
+    inline unsigned int GetThreadCount() const { return (unsigned int)m_Workers.size(); }
+};
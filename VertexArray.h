@@ -13,6 +13,11 @@ class VertexArray
         VertexArray();
         ~VertexArray();
 
+        VertexArray(const VertexArray&) = delete;
+        VertexArray& operator=(const VertexArray&) = delete;
+        VertexArray(VertexArray&& other) noexcept;
+        VertexArray& operator=(VertexArray&& other) noexcept;
+
         void AddBuffer( const VertexBuffer& vb, const VertexBufferLayout& layout);
         void Bind() const;
         void Unbind() const;
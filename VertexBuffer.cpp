@@ -1,21 +1,51 @@
 #include "VertexBuffer.h"
 #include "Renderer.h"
+#include "GpuMemory.h"
 
 VertexBuffer::VertexBuffer(const void *data, unsigned int size)
+    : m_Size(size)
 {
     glGenBuffers(1, &m_RendererID);
     glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
     glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+    m_AllocationID = GpuMemory::Get().Register(GpuResourceCategory::VERTEX_BUFFER, size);
+    GpuMemory::Get().EnforceBudget();
 }
 
 VertexBuffer::~VertexBuffer()
 {
     glDeleteBuffers(1, &m_RendererID);
+    GpuMemory::Get().Unregister(m_AllocationID);
+}
+
+VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept
+    : m_RendererID(other.m_RendererID), m_Size(other.m_Size), m_AllocationID(other.m_AllocationID)
+{
+    other.m_RendererID = 0;
+    other.m_Size = 0;
+    other.m_AllocationID = 0;
+}
+
+VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        glDeleteBuffers(1, &m_RendererID);
+        GpuMemory::Get().Unregister(m_AllocationID);
+        m_RendererID = other.m_RendererID;
+        m_Size = other.m_Size;
+        m_AllocationID = other.m_AllocationID;
+        other.m_RendererID = 0;
+        other.m_Size = 0;
+        other.m_AllocationID = 0;
+    }
+    return *this;
 }
 
 void VertexBuffer::Bind() const
 {
     glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+    GpuMemory::Get().Touch(m_AllocationID);
 }
 
 void VertexBuffer::Unbind() const
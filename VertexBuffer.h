@@ -8,12 +8,23 @@ class VertexBuffer
     private:
         /* data */
         unsigned int m_RendererID;
+        unsigned int m_Size;
+        unsigned int m_AllocationID;
     public:
         VertexBuffer(const void* data, unsigned int size);
         ~VertexBuffer();
 
+        VertexBuffer(const VertexBuffer&) = delete;
+        VertexBuffer& operator=(const VertexBuffer&) = delete;
+        VertexBuffer(VertexBuffer&& other) noexcept;
+        VertexBuffer& operator=(VertexBuffer&& other) noexcept;
+
         void Bind() const;
         void Unbind() const;
+
+        inline unsigned int GetSize() const { return m_Size; }
+        // GpuMemory id, as passed to its eviction handler
+        inline unsigned int GetAllocationID() const { return m_AllocationID; }
 };
 
 #endif
\ No newline at end of file
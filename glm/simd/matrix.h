@@ -1025,4 +1025,196 @@ GLM_FUNC_QUALIFIER void glm_mat4_outerProduct(__m128 const& c, __m128 const& r,
 	out[3] = _mm_mul_ps(c, _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 3)));
 }
 
+// 256-bit kernels: AVX, with FMA where available. When AVX is enabled for the
+// whole build these are ordinary inline functions. Otherwise, on GCC and Clang,
+// they are compiled per function for AVX+FMA so that a runtime dispatcher can
+// select them on hosts that support it; callers must check the CPU first.
+#if GLM_ARCH & GLM_ARCH_AVX_BIT
+#	define GLM_HAS_AVX_KERNELS 1
+#	define GLM_AVX_FUNC_QUALIFIER GLM_FUNC_QUALIFIER
+#	if defined(__FMA__)
+#		define GLM_AVX_KERNELS_FMA 1
+#	else
+#		define GLM_AVX_KERNELS_FMA 0
+#	endif
+#elif GLM_COMPILER & (GLM_COMPILER_GCC | GLM_COMPILER_CLANG)
+#	include <immintrin.h>
+#	define GLM_HAS_AVX_KERNELS 1
+#	define GLM_AVX_FUNC_QUALIFIER inline __attribute__((target("avx,fma")))
+#	define GLM_AVX_KERNELS_FMA 1
+#else
+#	define GLM_HAS_AVX_KERNELS 0
+#endif
+
+#if GLM_HAS_AVX_KERNELS
+
+GLM_AVX_FUNC_QUALIFIER __m256 glm_avx_fmadd(__m256 a, __m256 b, __m256 c)
+{
+#	if GLM_AVX_KERNELS_FMA
+	return _mm256_fmadd_ps(a, b, c);
+#	else
+	return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#	endif
+}
+
+GLM_AVX_FUNC_QUALIFIER __m256 glm_avx_fmsub(__m256 a, __m256 b, __m256 c)
+{
+#	if GLM_AVX_KERNELS_FMA
+	return _mm256_fmsub_ps(a, b, c);
+#	else
+	return _mm256_sub_ps(_mm256_mul_ps(a, b), c);
+#	endif
+}
+
+// [lo | hi]
+GLM_AVX_FUNC_QUALIFIER __m256 glm_avx_pair(__m128 lo, __m128 hi)
+{
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+// Two result columns per register: column j of the product is
+// in1 * in2[j], so [out0 | out1] = sum_k [in1[k] | in1[k]] * [in2[0][k] | in2[1][k]].
+GLM_AVX_FUNC_QUALIFIER void glm_mat4_mul_avx(glm_vec4 const in1[4], glm_vec4 const in2[4], glm_vec4 out[4])
+{
+	__m256 a0 = glm_avx_pair(in1[0], in1[0]);
+	__m256 a1 = glm_avx_pair(in1[1], in1[1]);
+	__m256 a2 = glm_avx_pair(in1[2], in1[2]);
+	__m256 a3 = glm_avx_pair(in1[3], in1[3]);
+
+	__m256 b01 = glm_avx_pair(in2[0], in2[1]);
+	__m256 b23 = glm_avx_pair(in2[2], in2[3]);
+
+	__m256 r01 = _mm256_mul_ps(a0, _mm256_permute_ps(b01, _MM_SHUFFLE(0, 0, 0, 0)));
+	__m256 r23 = _mm256_mul_ps(a0, _mm256_permute_ps(b23, _MM_SHUFFLE(0, 0, 0, 0)));
+	r01 = glm_avx_fmadd(a1, _mm256_permute_ps(b01, _MM_SHUFFLE(1, 1, 1, 1)), r01);
+	r23 = glm_avx_fmadd(a1, _mm256_permute_ps(b23, _MM_SHUFFLE(1, 1, 1, 1)), r23);
+	r01 = glm_avx_fmadd(a2, _mm256_permute_ps(b01, _MM_SHUFFLE(2, 2, 2, 2)), r01);
+	r23 = glm_avx_fmadd(a2, _mm256_permute_ps(b23, _MM_SHUFFLE(2, 2, 2, 2)), r23);
+	r01 = glm_avx_fmadd(a3, _mm256_permute_ps(b01, _MM_SHUFFLE(3, 3, 3, 3)), r01);
+	r23 = glm_avx_fmadd(a3, _mm256_permute_ps(b23, _MM_SHUFFLE(3, 3, 3, 3)), r23);
+
+	out[0] = _mm256_castps256_ps128(r01);
+	out[1] = _mm256_extractf128_ps(r01, 1);
+	out[2] = _mm256_castps256_ps128(r23);
+	out[3] = _mm256_extractf128_ps(r23, 1);
+}
+
+GLM_AVX_FUNC_QUALIFIER glm_vec4 glm_mat4_mul_vec4_avx(glm_vec4 const m[4], glm_vec4 v)
+{
+	__m256 vv = glm_avx_pair(v, v);
+	__m256 v01 = _mm256_permutevar_ps(vv, _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1));
+	__m256 v23 = _mm256_permutevar_ps(vv, _mm256_setr_epi32(2, 2, 2, 2, 3, 3, 3, 3));
+
+	__m256 s = _mm256_mul_ps(glm_avx_pair(m[0], m[1]), v01);
+	s = glm_avx_fmadd(glm_avx_pair(m[2], m[3]), v23, s);
+
+	return _mm_add_ps(_mm256_castps256_ps128(s), _mm256_extractf128_ps(s, 1));
+}
+
+GLM_AVX_FUNC_QUALIFIER void glm_mat4_transpose_avx(glm_vec4 const in[4], glm_vec4 out[4])
+{
+	__m256 a = glm_avx_pair(in[0], in[2]);
+	__m256 b = glm_avx_pair(in[1], in[3]);
+
+	// [c0.x c1.x c0.y c1.y | c2.x c3.x c2.y c3.y], [... .z .w ...]
+	__m256 lo = _mm256_unpacklo_ps(a, b);
+	__m256 hi = _mm256_unpackhi_ps(a, b);
+
+	__m256 x = _mm256_permute2f128_ps(lo, hi, 0x20);
+	__m256 y = _mm256_permute2f128_ps(lo, hi, 0x31);
+
+	__m256 r02 = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(1, 0, 1, 0));
+	__m256 r13 = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(3, 2, 3, 2));
+
+	out[0] = _mm256_castps256_ps128(r02);
+	out[1] = _mm256_castps256_ps128(r13);
+	out[2] = _mm256_extractf128_ps(r02, 1);
+	out[3] = _mm256_extractf128_ps(r13, 1);
+}
+
+// 2x2 matrix helpers on [a b c d] blocks, two blocks per register
+// v1 * v2
+GLM_AVX_FUNC_QUALIFIER __m256 glm_avx_mat2_mul(__m256 v1, __m256 v2)
+{
+	__m256 t = _mm256_mul_ps(_mm256_permute_ps(v1, _MM_SHUFFLE(2, 3, 0, 1)), _mm256_permute_ps(v2, _MM_SHUFFLE(1, 2, 1, 2)));
+	return glm_avx_fmadd(v1, _mm256_permute_ps(v2, _MM_SHUFFLE(3, 0, 3, 0)), t);
+}
+
+// adjugate(v1) * v2
+GLM_AVX_FUNC_QUALIFIER __m256 glm_avx_mat2_adj_mul(__m256 v1, __m256 v2)
+{
+	__m256 t = _mm256_mul_ps(_mm256_permute_ps(v1, _MM_SHUFFLE(2, 2, 1, 1)), _mm256_permute_ps(v2, _MM_SHUFFLE(1, 0, 3, 2)));
+	return glm_avx_fmsub(_mm256_permute_ps(v1, _MM_SHUFFLE(0, 0, 3, 3)), v2, t);
+}
+
+// v1 * adjugate(v2)
+GLM_AVX_FUNC_QUALIFIER __m256 glm_avx_mat2_mul_adj(__m256 v1, __m256 v2)
+{
+	__m256 t = _mm256_mul_ps(_mm256_permute_ps(v1, _MM_SHUFFLE(2, 3, 0, 1)), _mm256_permute_ps(v2, _MM_SHUFFLE(1, 2, 1, 2)));
+	return glm_avx_fmsub(v1, _mm256_permute_ps(v2, _MM_SHUFFLE(0, 3, 0, 3)), t);
+}
+
+// Block-wise inverse: the matrix is split into 2x2 blocks A B / C D and the
+// inverse built from their adjugates. The block products come in symmetric
+// pairs (A with D, B with C), which fill both halves of each register.
+// Like glm_mat4_inverse, a singular input divides by zero.
+GLM_AVX_FUNC_QUALIFIER void glm_mat4_inverse_avx(glm_vec4 const in[4], glm_vec4 out[4])
+{
+	__m128 A = _mm_movelh_ps(in[0], in[1]);
+	__m128 B = _mm_movehl_ps(in[1], in[0]);
+	__m128 C = _mm_movelh_ps(in[2], in[3]);
+	__m128 D = _mm_movehl_ps(in[3], in[2]);
+
+	// determinants of A, B, C, D
+	__m128 DetSub = _mm_sub_ps(
+		_mm_mul_ps(_mm_shuffle_ps(in[0], in[2], _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(in[1], in[3], _MM_SHUFFLE(3, 1, 3, 1))),
+		_mm_mul_ps(_mm_shuffle_ps(in[0], in[2], _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(in[1], in[3], _MM_SHUFFLE(2, 0, 2, 0))));
+
+	__m256 AD = glm_avx_pair(A, D);
+	__m256 DA = glm_avx_pair(D, A);
+	__m256 CB = glm_avx_pair(C, B);
+	__m256 BC = glm_avx_pair(B, C);
+	__m256 DetDA = _mm256_permutevar_ps(glm_avx_pair(DetSub, DetSub), _mm256_setr_epi32(3, 3, 3, 3, 0, 0, 0, 0));
+	__m256 DetBC = _mm256_permutevar_ps(glm_avx_pair(DetSub, DetSub), _mm256_setr_epi32(1, 1, 1, 1, 2, 2, 2, 2));
+
+	// [adj(D) * C | adj(A) * B]
+	__m256 DC_AB = glm_avx_mat2_adj_mul(DA, CB);
+	__m256 AB_DC = _mm256_permute2f128_ps(DC_AB, DC_AB, 0x01);
+
+	// [X | W] = [detD * A - B * DC | detA * D - C * AB]
+	// [Y | Z] = [detB * C - D * adj(AB) | detC * B - A * adj(DC)]
+	__m256 XW = glm_avx_fmsub(DetDA, AD, glm_avx_mat2_mul(BC, DC_AB));
+	__m256 YZ = glm_avx_fmsub(DetBC, CB, glm_avx_mat2_mul_adj(DA, AB_DC));
+
+	// det = detA * detD + detB * detC - tr(AB * DC)
+	__m128 DC = _mm256_castps256_ps128(DC_AB);
+	__m128 AB = _mm256_extractf128_ps(DC_AB, 1);
+	__m128 Det = _mm_add_ps(
+		_mm_mul_ps(_mm_shuffle_ps(DetSub, DetSub, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(DetSub, DetSub, _MM_SHUFFLE(3, 3, 3, 3))),
+		_mm_mul_ps(_mm_shuffle_ps(DetSub, DetSub, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(DetSub, DetSub, _MM_SHUFFLE(2, 2, 2, 2))));
+	__m128 Tr = _mm_mul_ps(AB, _mm_shuffle_ps(DC, DC, _MM_SHUFFLE(3, 1, 2, 0)));
+	Tr = _mm_hadd_ps(Tr, Tr);
+	Tr = _mm_hadd_ps(Tr, Tr);
+	Det = _mm_sub_ps(Det, Tr);
+
+	// adjugate signs folded into the reciprocal
+	__m128 RcpDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), Det);
+	__m256 RcpDet2 = glm_avx_pair(RcpDet, RcpDet);
+	XW = _mm256_mul_ps(XW, RcpDet2);
+	YZ = _mm256_mul_ps(YZ, RcpDet2);
+
+	// [X | Z] and [Y | W], then gather the result columns
+	__m256 XZ = _mm256_blend_ps(XW, YZ, 0xF0);
+	__m256 YW = _mm256_blend_ps(YZ, XW, 0xF0);
+	__m256 r02 = _mm256_shuffle_ps(XZ, YW, _MM_SHUFFLE(1, 3, 1, 3));
+	__m256 r13 = _mm256_shuffle_ps(XZ, YW, _MM_SHUFFLE(0, 2, 0, 2));
+
+	out[0] = _mm256_castps256_ps128(r02);
+	out[1] = _mm256_castps256_ps128(r13);
+	out[2] = _mm256_extractf128_ps(r02, 1);
+	out[3] = _mm256_extractf128_ps(r13, 1);
+}
+
+#endif//GLM_HAS_AVX_KERNELS
+
 #endif//GLM_ARCH & GLM_ARCH_SSE2_BIT
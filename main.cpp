@@ -11,16 +11,25 @@
 #include "Shader.h"
 #include "Renderer.h"
 #include "Texture.h"
+#include "TextureRegistry.h"
+#include "TextureCache.h"
+#include "AssetArchive.h"
+#include "GpuMemory.h"
+#include "DecodeArena.h"
+#include "Board.h"
+#include "NoGuessGenerator.h"
+#include "ThreadPool.h"
 
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <sstream>
 #include <cmath>
-#include <cstdlib>     /* srand, rand */
-#include <ctime>
-#include <queue>
-#include <utility>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include <memory>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 //void processInput(GLFWwindow *window);
@@ -29,66 +38,39 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 const unsigned int SCR_WIDTH = 640;
 const unsigned int SCR_HEIGHT = 640;
 
-const unsigned int GRID_WIDTH = 10;
-const unsigned int GRID_HEIGHT = 10;
-const float cellWidth = 50.0f;
-const float cellHeight = 50.0f;
-
-enum CellState {
-    HIDDEN,
-    REVEALED,
-    MEME,
-    FLAGGED
-};
-
-struct Cell {
-    CellState state = CellState::HIDDEN;
-    bool isMeme = false;  // Whether this cell contains a meme
-    int neighboringMemeCount = 0;  // Number of memes in adjacent cells
+const int DEFAULT_BOARD_WIDTH = 10;
+const int DEFAULT_BOARD_HEIGHT = 10;
+const int DEFAULT_MEME_COUNT = 10;
+// a no-guess board is searched among at most this many candidates, and
+// fewer on large boards so the first click does not stall for long
+const size_t MAX_NO_GUESS_CANDIDATES = 100000;
+const size_t NO_GUESS_CELL_BUDGET = (size_t)1 << 26;
+
+// the projection maps the window to world units -320..320 on both axes
+const float WORLD_SIZE = 640.0f;
+const float MAX_CELL_SIZE = 50.0f;
+const float BOARD_EXTENT = 500.0f;  // largest board side, leaving a 70 unit margin
+
+// Board placement in world units: cells are square, at most MAX_CELL_SIZE,
+// shrunk so the board fits in BOARD_EXTENT, and the board is centered
+struct BoardLayout {
+    float cellSize = MAX_CELL_SIZE;
+    glm::vec2 origin = glm::vec2(0.0f);  // bottom-left corner of cell (0, 0)
 };
 
-Cell grid[GRID_HEIGHT][GRID_WIDTH];
+std::unique_ptr<Board> board;
+BoardLayout boardLayout;
+// generation and large openings run on every core
+std::unique_ptr<ThreadPool> workers;
 bool firstClick = false;
-
-void calculateMemeCounts() {
-    // Directions for the 8 neighboring cells
-    const int dx[] = {-1, -1, -1,  0, 0, 1, 1, 1};
-    const int dy[] = {-1,  0,  1, -1, 1, -1, 0, 1};
-
-    for (int y = 0; y < GRID_HEIGHT; ++y) {
-        for (int x = 0; x < GRID_WIDTH; ++x) {
-            // Skip cells that are memes
-            if (grid[y][x].isMeme) continue;
-
-            // Check the 8 neighboring cells
-            for (int i = 0; i < 8; ++i) {
-                int nx = x + dx[i];
-                int ny = y + dy[i];
-
-                // Ensure the neighbor is within the grid bounds
-                if (nx >= 0 && nx < GRID_WIDTH && ny >= 0 && ny < GRID_HEIGHT) {
-                    if (grid[ny][nx].isMeme) {
-                        grid[y][x].neighboringMemeCount++;
-                    }
-                }
-            }
-        }
-    }
-}
-
-void placeMemes(int numMemes) {
-    int placedMemes = 0;
-    std::srand(std::time(nullptr));
-    while (placedMemes < numMemes) {
-        int x = std::rand() % GRID_WIDTH;
-        int y = std::rand() % GRID_HEIGHT;
-
-        // If there's no meme at this position, place one
-        if (!grid[y][x].isMeme) {
-            grid[y][x].isMeme = true;
-            placedMemes++;
-        }
-    }
+// with --no-guess the board is regenerated on the first click, around it
+bool noGuess = false;
+
+BoardLayout computeLayout(const Board& b) {
+    BoardLayout l;
+    l.cellSize = std::min(MAX_CELL_SIZE, BOARD_EXTENT / std::max(b.GetWidth(), b.GetHeight()));
+    l.origin = glm::vec2(-0.5f * b.GetWidth() * l.cellSize, -0.5f * b.GetHeight() * l.cellSize);
+    return l;
 }
 
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
@@ -97,100 +79,79 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
         // Get the mouse position
         glfwGetCursorPos(window, &xpos, &ypos);
 
-        // Define constants
-        int cell_size = 50;          // Actual cell size
-        int grid_size = 500;         // 10x10 grid with 50x50 cells
-        int window_size = 640;       // Window size
-        int offset = (window_size - grid_size) / 2;  // Offset for centering (70 pixels)
-
-        // Invert the y-coordinate
-        ypos = window_size - ypos;
-
-        // Adjust for the offset
-        xpos -= offset;
-        ypos -= offset;
+        // Window pixels to world units; window y points down
+        int windowWidth, windowHeight;
+        glfwGetWindowSize(window, &windowWidth, &windowHeight);
+        if (windowWidth <= 0 || windowHeight <= 0)
+            return;
+        double worldX = xpos / windowWidth * WORLD_SIZE - 0.5 * WORLD_SIZE;
+        double worldY = (1.0 - ypos / windowHeight) * WORLD_SIZE - 0.5 * WORLD_SIZE;
 
         // Calculate the grid cell based on mouse position
-        int grid_x = static_cast<int>(std::round(xpos)) / cell_size;
-        int grid_y = static_cast<int>(std::round(ypos)) / cell_size;
-        
-        // The grid is assumed to be a 2D array of Cells, where each Cell has a boolean isRevealed and isMeme.
+        int grid_x = static_cast<int>(std::floor((worldX - boardLayout.origin.x) / boardLayout.cellSize));
+        int grid_y = static_cast<int>(std::floor((worldY - boardLayout.origin.y) / boardLayout.cellSize));
 
-        
+        // Ensure the click is within the grid bounds
+        if (!board->Contains(grid_x, grid_y)) {
+            std::cout << "Click was outside the grid." << std::endl;
+            return;
+        }
 
         if(!firstClick){
-            // Use a flood-fill algorithm to reveal a "safe" area
-            
-            // Check if the starting position is safe
-            if (grid[grid_y][grid_x].isMeme) {
-                // In some versions of Minesweeper, the game would reposition the meme if you click on one first
-                // You can handle this however you'd like.
-                return; // Or reposition the meme at this point
+            if (noGuess) {
+                // candidates of the board's seed until the solver clears one from this click
+                uint64_t seed = board->GetSeed();
+                size_t candidates = std::max<size_t>(1, std::min(MAX_NO_GUESS_CANDIDATES, NO_GUESS_CELL_BUDGET / board->GetCellCount()));
+                NoGuessResult result = NoGuessGenerator::Generate(*board, seed, grid_x, grid_y, candidates, workers.get());
+                if (result.Found)
+                    std::cout << "no-guess board: seed " << seed << " candidate " << result.Candidate << " of " << result.Tested << " tested" << std::endl;
+                else
+                    std::cout << "No no-guess board among " << result.Tested << " candidates, playing seed " << seed << std::endl;
             }
-
-            // Use a queue for breadth-first search (BFS) to reveal neighboring squares
-            std::queue<std::pair<int, int>> toReveal;
-            toReveal.push({grid_x, grid_y});
-
-            while (!toReveal.empty()) {
-                auto [x, y] = toReveal.front();
-                toReveal.pop();
-
-                // Check bounds
-                if (x < 0 || x >= GRID_WIDTH || y < 0 || y >= GRID_HEIGHT)
-                    continue;
-
-                // If the cell is already revealed or is a meme, skip it
-                if (grid[y][x].state == CellState::REVEALED || grid[y][x].isMeme)
-                    continue;
-
-                // Reveal the cell
-                grid[y][x].state = CellState::REVEALED;
-
-                // Count neighboring memes
-                int memeCount = grid[y][x].neighboringMemeCount;
-
-                // If no adjacent memes, reveal neighbors
-                if (memeCount == 0) {
-                    // Add neighboring cells to the queue
-                    for (int offsetY = -1; offsetY <= 1; ++offsetY) {
-                        for (int offsetX = -1; offsetX <= 1; ++offsetX) {
-                            if (offsetX == 0 && offsetY == 0) continue;  // Skip the current cell
-                            toReveal.push({x + offsetX, y + offsetY});
-                        }
-                    }
-
-                    firstClick = true;
-
-                }
+            // Reveal a "safe" area; cells without adjacent memes flood outwards
+            if (board->IsMine(grid_x, grid_y)) {
+                // The first click is always safe: like the classic game, the meme moves to
+                // the first free cell, and only the counts around both cells change
+                int free_x, free_y;
+                if (!board->FindFreeCell(free_x, free_y) || !board->MoveMine(grid_x, grid_y, free_x, free_y))
+                    return;
             }
-            
-            
-
+            board->Reveal(grid_x, grid_y, workers.get());
+            firstClick = true;
         } else {
-            // Ensure the click is within the grid bounds
-            if (xpos >= 0 && xpos < grid_size && ypos >= 0 && ypos < grid_size) {
-                if (button == GLFW_MOUSE_BUTTON_LEFT) {
-                    std::cout << "Left mouse button pressed at (" << xpos << ", " << ypos << ")" << std::endl;
-                    grid[grid_y][grid_x].state = CellState::FLAGGED;
-                }
-                if (button == GLFW_MOUSE_BUTTON_RIGHT) {
-                    std::cout << "Right mouse button pressed at (" << xpos << ", " << ypos << ")" << std::endl;
-                    if(grid[grid_y][grid_x].isMeme)
-                        grid[grid_y][grid_x].state = CellState::MEME;
-                    else if (!grid[grid_y][grid_x].isMeme)
-                        grid[grid_y][grid_x].state = CellState::REVEALED;
-                }
-            } else {
-                std::cout << "Click was outside the grid." << std::endl;
+            if (button == GLFW_MOUSE_BUTTON_LEFT) {
+                std::cout << "Left mouse button pressed at (" << grid_x << ", " << grid_y << ")" << std::endl;
+                board->ToggleFlag(grid_x, grid_y);
+            }
+            if (button == GLFW_MOUSE_BUTTON_RIGHT) {
+                std::cout << "Right mouse button pressed at (" << grid_x << ", " << grid_y << ")" << std::endl;
+                board->Reveal(grid_x, grid_y, workers.get());
             }
         }
 
     }
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    // optional no-guess mode, board size, meme count and seed:
+    // main [--no-guess] [width height [memes [seed]]]
+    int arg = 1;
+    if (argc > arg && std::strcmp(argv[arg], "--no-guess") == 0)
+    {
+        noGuess = true;
+        arg++;
+    }
+    int boardWidth = argc > arg + 1 ? std::atoi(argv[arg]) : DEFAULT_BOARD_WIDTH;
+    int boardHeight = argc > arg + 1 ? std::atoi(argv[arg + 1]) : DEFAULT_BOARD_HEIGHT;
+    int memeCount = argc > arg + 2 ? std::atoi(argv[arg + 2]) : DEFAULT_MEME_COUNT;
+    uint64_t seed = argc > arg + 3 ? std::strtoull(argv[arg + 3], nullptr, 10) : Board::NewSeed();
+    if (boardWidth <= 0 || boardHeight <= 0)
+    {
+        std::cout << "usage: main [--no-guess] [width height [memes [seed]]]" << std::endl;
+        return -1;
+    }
+
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
@@ -229,23 +190,19 @@ int main()
     {
 
         
-        placeMemes(10);
-        calculateMemeCounts();
-
-        for (size_t y = 0; y < GRID_HEIGHT; y++)
-        {
-            for (size_t x = 0; x < GRID_WIDTH; x++)
-            {
-                std::cout << " grid cell [ " << y << ", " << x << " ] " << grid[y][x].neighboringMemeCount << ", "<< grid[y][x].isMeme << std::endl;
-            }
-            
-        }
-        
+        board = std::make_unique<Board>(boardWidth, boardHeight, memeCount);
+        workers = std::make_unique<ThreadPool>();
+        board->Generate(seed, workers.get());
+        boardLayout = computeLayout(*board);
+        std::cout << "board " << board->GetWidth() << "x" << board->GetHeight() << ", " << board->GetMineCount() << " memes, seed " << board->GetSeed() << std::endl;
+
+        // one cell at the origin; each draw offsets it to its cell
+        float c = boardLayout.cellSize;
         float vertices[] = {
-            -250.0f,  -250.0f,   0.0f, 0.0f, // left  
-            -200.0f,  -250.0f,   1.0f, 0.0f, // right 
-            -200.0f,  -200.0f,   1.0f, 1.0f, // top  
-            -250.0f,  -200.0f,   0.0f, 1.0f
+            0.0f, 0.0f,   0.0f, 0.0f, // left  
+            c,    0.0f,   1.0f, 0.0f, // right 
+            c,    c,      1.0f, 1.0f, // top  
+            0.0f, c,      0.0f, 1.0f
         };
         
       
@@ -279,39 +236,55 @@ int main()
         //glm::mat4 proj = glm::ortho(-2.0f, 2.0f, -1.5f, 1.5f);
         glm::mat4 proj = glm::ortho(-320.0f, 320.0f, -320.0f, 320.0f, -1.0f, 1.0f);
 
-        Shader shader("basic.shader");
+        // packed assets (see tools/pack_assets.cpp) take precedence over loose files
+        AssetArchive assets("assets.pak");
+        AssetView shaderAsset = assets.Find("basic.shader");
+        Shader shader = shaderAsset.IsValid()
+            ? Shader("basic.shader", shaderAsset.GetText())
+            : Shader("basic.shader");
         //shader.SetUniform4f("u_Color", 1.0f, 0.5f, 0.2f, 1.0f);
         
 
         //Texture texture("pngegg.png");
-        Texture hidden ("res/hidden.png");
-        Texture flag ("res/flag.png");
-        Texture mine ("res/mine.png");
-
-        Texture textures[9] = {
-            Texture("res/zero.png"), // For 0 adjacent memes
-            Texture("res/one.png"), // For 1 adjacent meme
-            Texture("res/two.png"), // For 2 adjacent memes
-            Texture("res/three.png"), // For 3 adjacent memes
-            Texture("res/four.png"), // For 4 adjacent memes
-            Texture("res/five.png"), // For 5 adjacent memes
-            Texture("res/six.png"), // For 6 adjacent memes
-            Texture("res/seven.png"), // For 7 adjacent memes
-            Texture("res/eight.png")  // For 8 adjacent memes
+        TextureRegistry textureRegistry(&assets);
+        std::shared_ptr<Texture> hidden = textureRegistry.Acquire("res/hidden.png");
+        std::shared_ptr<Texture> flag = textureRegistry.Acquire("res/flag.png");
+        std::shared_ptr<Texture> mine = textureRegistry.Acquire("res/mine.png");
+
+        const char* countTexturePaths[9] = {
+            "res/zero.png", // For 0 adjacent memes
+            "res/one.png", // For 1 adjacent meme
+            "res/two.png", // For 2 adjacent memes
+            "res/three.png", // For 3 adjacent memes
+            "res/four.png", // For 4 adjacent memes
+            "res/five.png", // For 5 adjacent memes
+            "res/six.png", // For 6 adjacent memes
+            "res/seven.png", // For 7 adjacent memes
+            "res/eight.png"  // For 8 adjacent memes
         };
+        std::vector<std::shared_ptr<Texture>> textures;
+        textures.reserve(9);
+        for (const char* path : countTexturePaths)
+            textures.push_back(textureRegistry.Acquire(path));
+
+        TextureCache::Get().PrintStats();
+        GpuMemory::Get().PrintStats();
+        DecodeArena::Get().PrintStats();
         
         shader.SetUniform1i("u_Texture", 0);
 
 
-        glm::vec2 offsets[GRID_WIDTH * GRID_HEIGHT];
+        const int gridWidth = board->GetWidth();
+        const int gridHeight = board->GetHeight();
+        std::vector<glm::vec2> offsets((size_t)gridWidth * gridHeight);
         
-        for (int y = 0; y < GRID_HEIGHT; y++) {
-            for (int x = 0; x < GRID_WIDTH; x++) {
-                offsets[y * GRID_WIDTH + x] = glm::vec2(x * cellWidth, y * cellHeight);  // Position each cell in the grid
+        for (int y = 0; y < gridHeight; y++) {
+            for (int x = 0; x < gridWidth; x++) {
+                offsets[(size_t)y * gridWidth + x] = boardLayout.origin + glm::vec2(x, y) * boardLayout.cellSize;  // Position each cell in the grid
             }
         }
 
-        // VertexBuffer instancedVBO ( offsets, GRID_HEIGHT * GRID_WIDTH * 2 * sizeof(float) );
+        // VertexBuffer instancedVBO ( offsets, gridHeight * gridWidth * 2 * sizeof(float) );
         // // Now, bind it to the quad VAO
         // glEnableVertexAttribArray(2);
         // glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
@@ -345,27 +318,27 @@ int main()
             shader.Bind();
             
 
-            for (int y = 0; y < GRID_HEIGHT; ++y) {
-                for (int x = 0; x < GRID_WIDTH; ++x) {
-                    Cell &cell = grid[y][x];
+            for (int y = 0; y < gridHeight; ++y) {
+                for (int x = 0; x < gridWidth; ++x) {
+                    int neighboringMemeCount = board->GetNeighborCount(x, y);
 
                     // Set the texture based on the cell state
-                    switch (cell.state) {
-                        case HIDDEN:
-                            hidden.Bind();
+                    switch (board->GetState(x, y)) {
+                        case CellState::HIDDEN:
+                            hidden->Bind();
                             break;
-                        case REVEALED:
-                            textures[cell.neighboringMemeCount].Bind();
+                        case CellState::REVEALED:
+                            textures[neighboringMemeCount]->Bind();
                             break;
-                        case MEME:
-                            mine.Bind();
+                        case CellState::MEME:
+                            mine->Bind();
                             break;
-                        case FLAGGED:
-                            flag.Bind();
+                        case CellState::FLAGGED:
+                            flag->Bind();
                             break;
                     }
 
-                    glm::vec2 offset = offsets[y * GRID_WIDTH + x];
+                    glm::vec2 offset = offsets[(size_t)y * gridWidth + x];
 
                     
                     VertexBuffer instuniqueVBO ( &offset, 2 * sizeof(float) );
@@ -380,10 +353,10 @@ int main()
                     renderer.Draw(va, ibo, shader);
 
                     
-                    textures[cell.neighboringMemeCount].Unbind();
-                    hidden.Unbind();
-                    flag.Unbind();
-                    mine.Unbind();
+                    textures[neighboringMemeCount]->Unbind();
+                    hidden->Unbind();
+                    flag->Unbind();
+                    mine->Unbind();
                 }
             }
 
@@ -1,2 +1,9 @@
+#include "DecodeArena.h"
+
+// decodes allocate from the calling thread's arena; see DecodeArena.h
+#define STBI_MALLOC(size)           DecodeArena::Get().Allocate(size)
+#define STBI_REALLOC(block, size)   DecodeArena::Get().Reallocate(block, size)
+#define STBI_FREE(block)            DecodeArena::Get().Free(block)
+
 #define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
\ No newline at end of file
+#include "stb_image.h"
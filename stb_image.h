@@ -421,6 +421,14 @@ typedef struct
 //
 
 STBIDEF stbi_uc *stbi_load_from_memory   (stbi_uc           const *buffer, int len   , int *x, int *y, int *channels_in_file, int desired_channels);
+
+// Decodes into a caller-provided buffer (e.g. a mapped pixel unpack buffer or
+// file mapping) of dest_size >= x*y*desired_channels bytes; desired_channels
+// must be 1..4. Honors stbi_set_flip_vertically_on_load. Non-interlaced PNG
+// and JPEG write their rows straight into dest in final order; other images
+// are decoded to a temporary and copied in once, rows reversed if flipping.
+// Returns dest, or NULL on failure.
+STBIDEF stbi_uc *stbi_load_from_memory_into(stbi_uc const *buffer, int len, stbi_uc *dest, size_t dest_size, int *x, int *y, int *channels_in_file, int desired_channels);
 STBIDEF stbi_uc *stbi_load_from_callbacks(stbi_io_callbacks const *clbk  , void *user, int *x, int *y, int *channels_in_file, int desired_channels);
 
 #ifndef STBI_NO_STDIO
@@ -514,6 +522,13 @@ STBIDEF void stbi_set_unpremultiply_on_load(int flag_true_if_should_unpremultipl
 // or just pass them through "as-is"
 STBIDEF void stbi_convert_iphone_png_to_rgb(int flag_true_if_should_convert);
 
+// cap the SIMD level used for PNG unfiltering: 0 = scalar, 1 = SSE2, 2 = AVX2.
+// The best level the CPU supports is used by default; this is for benchmarks.
+STBIDEF void stbi_png_set_simd_limit(int level);
+
+// the same for the JPEG IDCT, color conversion and upsampling kernels
+STBIDEF void stbi_jpeg_set_simd_limit(int level);
+
 // flip the image vertically, so the first pixel in the output array is the bottom left
 STBIDEF void stbi_set_flip_vertically_on_load(int flag_true_if_should_flip);
 
@@ -774,6 +789,37 @@ static int stbi__sse2_available(void)
 #endif
 #endif
 
+// x86 AVX2: compiled per function and selected at runtime, so a binary built
+// for plain SSE2 still uses it on hosts that have it. #define STBI_NO_AVX2 to
+// leave it out.
+#if defined(STBI_SSE2) && !defined(STBI_NO_AVX2)
+#if defined(__GNUC__) || defined(__clang__)
+#define STBI_AVX2
+#include <immintrin.h>
+#define STBI__AVX2_TARGET __attribute__((target("avx2")))
+static int stbi__avx2_available(void)
+{
+   __builtin_cpu_init();
+   return __builtin_cpu_supports("avx2");
+}
+#elif defined(_MSC_VER) && _MSC_VER >= 1900
+#define STBI_AVX2
+#include <immintrin.h>
+#define STBI__AVX2_TARGET
+static int stbi__avx2_available(void)
+{
+   int info[4];
+   __cpuid(info, 0);
+   if (info[0] < 7) return 0;
+   __cpuid(info, 1);
+   // OSXSAVE and AVX, and the OS saves the YMM state
+   if ((info[2] & 0x18000000) != 0x18000000 || (_xgetbv(0) & 6) != 6) return 0;
+   __cpuidex(info, 7, 0);
+   return (info[1] >> 5) & 1;
+}
+#endif
+#endif
+
 // ARM NEON
 #if defined(STBI_NO_SIMD) && defined(STBI_NEON)
 #undef STBI_NEON
@@ -817,6 +863,12 @@ typedef struct
 
    stbi_uc *img_buffer, *img_buffer_end;
    stbi_uc *img_buffer_original, *img_buffer_original_end;
+
+   // output requests: decoders that can write rows in either order, or into
+   // the caller's buffer, do so and report it in stbi__result_info
+   int flip_rows;
+   stbi_uc *dest;
+   size_t dest_size;
 } stbi__context;
 
 
@@ -830,6 +882,9 @@ static void stbi__start_mem(stbi__context *s, stbi_uc const *buffer, int len)
    s->callback_already_read = 0;
    s->img_buffer = s->img_buffer_original = (stbi_uc *) buffer;
    s->img_buffer_end = s->img_buffer_original_end = (stbi_uc *) buffer+len;
+   s->flip_rows = 0;
+   s->dest = NULL;
+   s->dest_size = 0;
 }
 
 // initialize a callback-based context
@@ -841,6 +896,9 @@ static void stbi__start_callbacks(stbi__context *s, stbi_io_callbacks *c, void *
    s->read_from_callbacks = 1;
    s->callback_already_read = 0;
    s->img_buffer = s->img_buffer_original = s->buffer_start;
+   s->flip_rows = 0;
+   s->dest = NULL;
+   s->dest_size = 0;
    stbi__refill_buffer(s);
    s->img_buffer_original_end = s->img_buffer_end;
 }
@@ -903,6 +961,7 @@ typedef struct
    int bits_per_channel;
    int num_channels;
    int channel_order;
+   int flipped; // rows already stored bottom-up, as requested by flip_rows
 } stbi__result_info;
 
 #ifndef STBI_NO_JPEG
@@ -1260,7 +1319,10 @@ static void stbi__vertical_flip_slices(void *image, int w, int h, int z, int byt
 static unsigned char *stbi__load_and_postprocess_8bit(stbi__context *s, int *x, int *y, int *comp, int req_comp)
 {
    stbi__result_info ri;
-   void *result = stbi__load_main(s, x, y, comp, req_comp, &ri, 8);
+   void *result;
+
+   s->flip_rows = stbi__vertically_flip_on_load;
+   result = stbi__load_main(s, x, y, comp, req_comp, &ri, 8);
 
    if (result == NULL)
       return NULL;
@@ -1275,7 +1337,7 @@ static unsigned char *stbi__load_and_postprocess_8bit(stbi__context *s, int *x,
 
    // @TODO: move stbi__convert_format to here
 
-   if (stbi__vertically_flip_on_load) {
+   if (stbi__vertically_flip_on_load && !ri.flipped) {
       int channels = req_comp ? req_comp : *comp;
       stbi__vertical_flip(result, *x, *y, channels * sizeof(stbi_uc));
    }
@@ -1286,7 +1348,10 @@ static unsigned char *stbi__load_and_postprocess_8bit(stbi__context *s, int *x,
 static stbi__uint16 *stbi__load_and_postprocess_16bit(stbi__context *s, int *x, int *y, int *comp, int req_comp)
 {
    stbi__result_info ri;
-   void *result = stbi__load_main(s, x, y, comp, req_comp, &ri, 16);
+   void *result;
+
+   s->flip_rows = stbi__vertically_flip_on_load;
+   result = stbi__load_main(s, x, y, comp, req_comp, &ri, 16);
 
    if (result == NULL)
       return NULL;
@@ -1302,7 +1367,7 @@ static stbi__uint16 *stbi__load_and_postprocess_16bit(stbi__context *s, int *x,
    // @TODO: move stbi__convert_format16 to here
    // @TODO: special case RGB-to-Y (and RGBA-to-YA) for 8-bit-to-16-bit case to keep more precision
 
-   if (stbi__vertically_flip_on_load) {
+   if (stbi__vertically_flip_on_load && !ri.flipped) {
       int channels = req_comp ? req_comp : *comp;
       stbi__vertical_flip(result, *x, *y, channels * sizeof(stbi__uint16));
    }
@@ -1433,6 +1498,42 @@ STBIDEF stbi_uc *stbi_load_from_memory(stbi_uc const *buffer, int len, int *x, i
    return stbi__load_and_postprocess_8bit(&s,x,y,comp,req_comp);
 }
 
+STBIDEF stbi_uc *stbi_load_from_memory_into(stbi_uc const *buffer, int len, stbi_uc *dest, size_t dest_size, int *x, int *y, int *comp, int req_comp)
+{
+   stbi__context s;
+   stbi__result_info ri;
+   stbi_uc *result;
+   size_t row_bytes;
+   int j;
+
+   if (req_comp < 1 || req_comp > 4) return stbi__errpuc("bad req_comp", "Internal error");
+   stbi__start_mem(&s,buffer,len);
+   s.flip_rows = stbi__vertically_flip_on_load;
+   s.dest = dest;
+   s.dest_size = dest_size;
+   result = (stbi_uc *) stbi__load_main(&s, x, y, comp, req_comp, &ri, 8);
+   if (result == NULL || result == dest)
+      return result; // decoded in place, rows already in final order
+
+   if (ri.bits_per_channel != 8) {
+      result = (stbi_uc *) stbi__convert_16_to_8((stbi__uint16 *) result, *x, *y, req_comp);
+      if (result == NULL) return NULL;
+   }
+
+   row_bytes = (size_t) *x * req_comp;
+   if (row_bytes * *y > dest_size) {
+      STBI_FREE(result);
+      return stbi__errpuc("dest too small", "Destination buffer too small");
+   }
+   // a single copy into place; taking rows in reverse replaces the flip pass
+   for (j=0; j < *y; ++j) {
+      int src = (s.flip_rows && !ri.flipped) ? *y - 1 - j : j;
+      memcpy(dest + row_bytes * j, result + row_bytes * src, row_bytes);
+   }
+   STBI_FREE(result);
+   return dest;
+}
+
 STBIDEF stbi_uc *stbi_load_from_callbacks(stbi_io_callbacks const *clbk, void *user, int *x, int *y, int *comp, int req_comp)
 {
    stbi__context s;
@@ -1996,6 +2097,8 @@ typedef struct
 
 // kernels
    void (*idct_block_kernel)(stbi_uc *out, int out_stride, short data[64]);
+   // two blocks per call; NULL when only the single-block kernel is available
+   void (*idct_block2_kernel)(stbi_uc *out0, int out_stride0, short data0[64], stbi_uc *out1, int out_stride1, short data1[64]);
    void (*YCbCr_to_RGB_kernel)(stbi_uc *out, const stbi_uc *y, const stbi_uc *pcb, const stbi_uc *pcr, int count, int step);
    stbi_uc *(*resample_row_hv_2_kernel)(stbi_uc *out, stbi_uc *in_near, stbi_uc *in_far, int w, int hs);
 } stbi__jpeg;
@@ -2704,6 +2807,201 @@ static void stbi__idct_simd(stbi_uc *out, int out_stride, short data[64])
 
 #endif // STBI_SSE2
 
+#ifdef STBI_AVX2
+// avx2 integer IDCT of two blocks at once: block 0 in the low 128-bit lane of
+// every register, block 1 in the high lane. Every step of the sse2 version is
+// lane-local, so this is the same code at twice the width and produces the
+// same bit-exact results.
+STBI__AVX2_TARGET
+static void stbi__idct_avx2_x2(stbi_uc *out0, int out_stride0, short data0[64], stbi_uc *out1, int out_stride1, short data1[64])
+{
+   __m256i row0, row1, row2, row3, row4, row5, row6, row7;
+   __m256i tmp;
+
+   // dot product constant: even elems=x, odd elems=y
+   #define dct_const(x,y)  _mm256_setr_epi16((x),(y),(x),(y),(x),(y),(x),(y),(x),(y),(x),(y),(x),(y),(x),(y))
+
+   // out(0) = c0[even]*x + c0[odd]*y   (c0, x, y 16-bit, out 32-bit)
+   // out(1) = c1[even]*x + c1[odd]*y
+   #define dct_rot(out0,out1, x,y,c0,c1) \
+      __m256i c0##lo = _mm256_unpacklo_epi16((x),(y)); \
+      __m256i c0##hi = _mm256_unpackhi_epi16((x),(y)); \
+      __m256i out0##_l = _mm256_madd_epi16(c0##lo, c0); \
+      __m256i out0##_h = _mm256_madd_epi16(c0##hi, c0); \
+      __m256i out1##_l = _mm256_madd_epi16(c0##lo, c1); \
+      __m256i out1##_h = _mm256_madd_epi16(c0##hi, c1)
+
+   // out = in << 12  (in 16-bit, out 32-bit)
+   #define dct_widen(out, in) \
+      __m256i out##_l = _mm256_srai_epi32(_mm256_unpacklo_epi16(_mm256_setzero_si256(), (in)), 4); \
+      __m256i out##_h = _mm256_srai_epi32(_mm256_unpackhi_epi16(_mm256_setzero_si256(), (in)), 4)
+
+   // wide add
+   #define dct_wadd(out, a, b) \
+      __m256i out##_l = _mm256_add_epi32(a##_l, b##_l); \
+      __m256i out##_h = _mm256_add_epi32(a##_h, b##_h)
+
+   // wide sub
+   #define dct_wsub(out, a, b) \
+      __m256i out##_l = _mm256_sub_epi32(a##_l, b##_l); \
+      __m256i out##_h = _mm256_sub_epi32(a##_h, b##_h)
+
+   // butterfly a/b, add bias, then shift by "s" and pack
+   #define dct_bfly32o(out0, out1, a,b,bias,s) \
+      { \
+         __m256i abiased_l = _mm256_add_epi32(a##_l, bias); \
+         __m256i abiased_h = _mm256_add_epi32(a##_h, bias); \
+         dct_wadd(sum, abiased, b); \
+         dct_wsub(dif, abiased, b); \
+         out0 = _mm256_packs_epi32(_mm256_srai_epi32(sum_l, s), _mm256_srai_epi32(sum_h, s)); \
+         out1 = _mm256_packs_epi32(_mm256_srai_epi32(dif_l, s), _mm256_srai_epi32(dif_h, s)); \
+      }
+
+   // 8-bit interleave step (for transposes)
+   #define dct_interleave8(a, b) \
+      tmp = a; \
+      a = _mm256_unpacklo_epi8(a, b); \
+      b = _mm256_unpackhi_epi8(tmp, b)
+
+   // 16-bit interleave step (for transposes)
+   #define dct_interleave16(a, b) \
+      tmp = a; \
+      a = _mm256_unpacklo_epi16(a, b); \
+      b = _mm256_unpackhi_epi16(tmp, b)
+
+   #define dct_pass(bias,shift) \
+      { \
+         /* even part */ \
+         dct_rot(t2e,t3e, row2,row6, rot0_0,rot0_1); \
+         __m256i sum04 = _mm256_add_epi16(row0, row4); \
+         __m256i dif04 = _mm256_sub_epi16(row0, row4); \
+         dct_widen(t0e, sum04); \
+         dct_widen(t1e, dif04); \
+         dct_wadd(x0, t0e, t3e); \
+         dct_wsub(x3, t0e, t3e); \
+         dct_wadd(x1, t1e, t2e); \
+         dct_wsub(x2, t1e, t2e); \
+         /* odd part */ \
+         dct_rot(y0o,y2o, row7,row3, rot2_0,rot2_1); \
+         dct_rot(y1o,y3o, row5,row1, rot3_0,rot3_1); \
+         __m256i sum17 = _mm256_add_epi16(row1, row7); \
+         __m256i sum35 = _mm256_add_epi16(row3, row5); \
+         dct_rot(y4o,y5o, sum17,sum35, rot1_0,rot1_1); \
+         dct_wadd(x4, y0o, y4o); \
+         dct_wadd(x5, y1o, y5o); \
+         dct_wadd(x6, y2o, y5o); \
+         dct_wadd(x7, y3o, y4o); \
+         dct_bfly32o(row0,row7, x0,x7,bias,shift); \
+         dct_bfly32o(row1,row6, x1,x6,bias,shift); \
+         dct_bfly32o(row2,row5, x2,x5,bias,shift); \
+         dct_bfly32o(row3,row4, x3,x4,bias,shift); \
+      }
+
+   // row r of block 0 in the low lane, of block 1 in the high lane
+   #define dct_load(r) \
+      _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *) (data0 + (r)*8))), \
+                              _mm_loadu_si128((const __m128i *) (data1 + (r)*8)), 1)
+
+   // each lane of p holds two output rows of its block
+   #define dct_store(p) \
+      { \
+         __m128i lo = _mm256_castsi256_si128(p); \
+         __m128i hi = _mm256_extracti128_si256(p, 1); \
+         _mm_storel_epi64((__m128i *) out0, lo); out0 += out_stride0; \
+         _mm_storel_epi64((__m128i *) out0, _mm_shuffle_epi32(lo, 0x4e)); out0 += out_stride0; \
+         _mm_storel_epi64((__m128i *) out1, hi); out1 += out_stride1; \
+         _mm_storel_epi64((__m128i *) out1, _mm_shuffle_epi32(hi, 0x4e)); out1 += out_stride1; \
+      }
+
+   __m256i rot0_0 = dct_const(stbi__f2f(0.5411961f), stbi__f2f(0.5411961f) + stbi__f2f(-1.847759065f));
+   __m256i rot0_1 = dct_const(stbi__f2f(0.5411961f) + stbi__f2f( 0.765366865f), stbi__f2f(0.5411961f));
+   __m256i rot1_0 = dct_const(stbi__f2f(1.175875602f) + stbi__f2f(-0.899976223f), stbi__f2f(1.175875602f));
+   __m256i rot1_1 = dct_const(stbi__f2f(1.175875602f), stbi__f2f(1.175875602f) + stbi__f2f(-2.562915447f));
+   __m256i rot2_0 = dct_const(stbi__f2f(-1.961570560f) + stbi__f2f( 0.298631336f), stbi__f2f(-1.961570560f));
+   __m256i rot2_1 = dct_const(stbi__f2f(-1.961570560f), stbi__f2f(-1.961570560f) + stbi__f2f( 3.072711026f));
+   __m256i rot3_0 = dct_const(stbi__f2f(-0.390180644f) + stbi__f2f( 2.053119869f), stbi__f2f(-0.390180644f));
+   __m256i rot3_1 = dct_const(stbi__f2f(-0.390180644f), stbi__f2f(-0.390180644f) + stbi__f2f( 1.501321110f));
+
+   // rounding biases in column/row passes, see stbi__idct_block for explanation.
+   __m256i bias_0 = _mm256_set1_epi32(512);
+   __m256i bias_1 = _mm256_set1_epi32(65536 + (128<<17));
+
+   // load
+   row0 = dct_load(0);
+   row1 = dct_load(1);
+   row2 = dct_load(2);
+   row3 = dct_load(3);
+   row4 = dct_load(4);
+   row5 = dct_load(5);
+   row6 = dct_load(6);
+   row7 = dct_load(7);
+
+   // column pass
+   dct_pass(bias_0, 10);
+
+   {
+      // 16bit 8x8 transpose pass 1
+      dct_interleave16(row0, row4);
+      dct_interleave16(row1, row5);
+      dct_interleave16(row2, row6);
+      dct_interleave16(row3, row7);
+
+      // transpose pass 2
+      dct_interleave16(row0, row2);
+      dct_interleave16(row1, row3);
+      dct_interleave16(row4, row6);
+      dct_interleave16(row5, row7);
+
+      // transpose pass 3
+      dct_interleave16(row0, row1);
+      dct_interleave16(row2, row3);
+      dct_interleave16(row4, row5);
+      dct_interleave16(row6, row7);
+   }
+
+   // row pass
+   dct_pass(bias_1, 17);
+
+   {
+      // pack
+      __m256i p0 = _mm256_packus_epi16(row0, row1);
+      __m256i p1 = _mm256_packus_epi16(row2, row3);
+      __m256i p2 = _mm256_packus_epi16(row4, row5);
+      __m256i p3 = _mm256_packus_epi16(row6, row7);
+
+      // 8bit 8x8 transpose pass 1
+      dct_interleave8(p0, p2);
+      dct_interleave8(p1, p3);
+
+      // transpose pass 2
+      dct_interleave8(p0, p1);
+      dct_interleave8(p2, p3);
+
+      // transpose pass 3
+      dct_interleave8(p0, p2);
+      dct_interleave8(p1, p3);
+
+      // store
+      dct_store(p0);
+      dct_store(p2);
+      dct_store(p1);
+      dct_store(p3);
+   }
+
+#undef dct_const
+#undef dct_rot
+#undef dct_widen
+#undef dct_wadd
+#undef dct_wsub
+#undef dct_bfly32o
+#undef dct_interleave8
+#undef dct_interleave16
+#undef dct_pass
+#undef dct_load
+#undef dct_store
+}
+#endif // STBI_AVX2
+
 #ifdef STBI_NEON
 
 // NEON integer IDCT. should produce bit-identical
@@ -2946,13 +3244,53 @@ static void stbi__jpeg_reset(stbi__jpeg *j)
    // since we don't even allow 1<<30 pixels
 }
 
+// baseline blocks are decoded into a batch and transformed in pairs when a
+// two-block IDCT kernel is available; the IDCT output is not read until the
+// whole scan is done, so delaying a block until its partner arrives is safe.
+// Flush before leaving the scan.
+typedef struct
+{
+   STBI_SIMD_ALIGN(short, data[2][64]);
+   stbi_uc *out;
+   int out_stride;
+   int pending;
+} stbi__idct_batch;
+
+// the coefficient buffer the next block should be decoded into
+static short *stbi__idct_batch_slot(stbi__idct_batch *b)
+{
+   return b->data[b->pending];
+}
+
+static void stbi__idct_batch_push(stbi__jpeg *z, stbi__idct_batch *b, stbi_uc *out, int out_stride)
+{
+   if (!z->idct_block2_kernel) {
+      z->idct_block_kernel(out, out_stride, b->data[0]);
+   } else if (!b->pending) {
+      b->out = out;
+      b->out_stride = out_stride;
+      b->pending = 1;
+   } else {
+      z->idct_block2_kernel(b->out, b->out_stride, b->data[0], out, out_stride, b->data[1]);
+      b->pending = 0;
+   }
+}
+
+static void stbi__idct_batch_flush(stbi__jpeg *z, stbi__idct_batch *b)
+{
+   if (b->pending) {
+      z->idct_block_kernel(b->out, b->out_stride, b->data[0]);
+      b->pending = 0;
+   }
+}
+
 static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
 {
    stbi__jpeg_reset(z);
    if (!z->progressive) {
       if (z->scan_n == 1) {
          int i,j;
-         STBI_SIMD_ALIGN(short, data[64]);
+         stbi__idct_batch batch;
          int n = z->order[0];
          // non-interleaved data, we just need to process one block at a time,
          // in trivial scanline order
@@ -2960,25 +3298,31 @@ static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
          // component has, independent of interleaved MCU blocking and such
          int w = (z->img_comp[n].x+7) >> 3;
          int h = (z->img_comp[n].y+7) >> 3;
+         batch.pending = 0;
          for (j=0; j < h; ++j) {
             for (i=0; i < w; ++i) {
                int ha = z->img_comp[n].ha;
-               if (!stbi__jpeg_decode_block(z, data, z->huff_dc+z->img_comp[n].hd, z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
-               z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8, z->img_comp[n].w2, data);
+               if (!stbi__jpeg_decode_block(z, stbi__idct_batch_slot(&batch), z->huff_dc+z->img_comp[n].hd, z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
+               stbi__idct_batch_push(z, &batch, z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8, z->img_comp[n].w2);
                // every data block is an MCU, so countdown the restart interval
                if (--z->todo <= 0) {
                   if (z->code_bits < 24) stbi__grow_buffer_unsafe(z);
                   // if it's NOT a restart, then just bail, so we get corrupt data
                   // rather than no data
-                  if (!STBI__RESTART(z->marker)) return 1;
+                  if (!STBI__RESTART(z->marker)) {
+                     stbi__idct_batch_flush(z, &batch);
+                     return 1;
+                  }
                   stbi__jpeg_reset(z);
                }
             }
          }
+         stbi__idct_batch_flush(z, &batch);
          return 1;
       } else { // interleaved
          int i,j,k,x,y;
-         STBI_SIMD_ALIGN(short, data[64]);
+         stbi__idct_batch batch;
+         batch.pending = 0;
          for (j=0; j < z->img_mcu_y; ++j) {
             for (i=0; i < z->img_mcu_x; ++i) {
                // scan an interleaved mcu... process scan_n components in order
@@ -2991,8 +3335,8 @@ static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
                         int x2 = (i*z->img_comp[n].h + x)*8;
                         int y2 = (j*z->img_comp[n].v + y)*8;
                         int ha = z->img_comp[n].ha;
-                        if (!stbi__jpeg_decode_block(z, data, z->huff_dc+z->img_comp[n].hd, z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
-                        z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*y2+x2, z->img_comp[n].w2, data);
+                        if (!stbi__jpeg_decode_block(z, stbi__idct_batch_slot(&batch), z->huff_dc+z->img_comp[n].hd, z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
+                        stbi__idct_batch_push(z, &batch, z->img_comp[n].data+z->img_comp[n].w2*y2+x2, z->img_comp[n].w2);
                      }
                   }
                }
@@ -3000,11 +3344,15 @@ static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
                // so now count down the restart interval
                if (--z->todo <= 0) {
                   if (z->code_bits < 24) stbi__grow_buffer_unsafe(z);
-                  if (!STBI__RESTART(z->marker)) return 1;
+                  if (!STBI__RESTART(z->marker)) {
+                     stbi__idct_batch_flush(z, &batch);
+                     return 1;
+                  }
                   stbi__jpeg_reset(z);
                }
             }
          }
+         stbi__idct_batch_flush(z, &batch);
          return 1;
       }
    } else {
@@ -3086,7 +3434,18 @@ static void stbi__jpeg_finish(stbi__jpeg *z)
          int w = (z->img_comp[n].x+7) >> 3;
          int h = (z->img_comp[n].y+7) >> 3;
          for (j=0; j < h; ++j) {
-            for (i=0; i < w; ++i) {
+            i = 0;
+            if (z->idct_block2_kernel) {
+               // horizontal neighbours in pairs
+               for (; i+1 < w; i += 2) {
+                  short *data = z->img_comp[n].coeff + 64 * (i + j * z->img_comp[n].coeff_w);
+                  stbi_uc *out = z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8;
+                  stbi__jpeg_dequantize(data, z->dequant[z->img_comp[n].tq]);
+                  stbi__jpeg_dequantize(data + 64, z->dequant[z->img_comp[n].tq]);
+                  z->idct_block2_kernel(out, z->img_comp[n].w2, data, out + 8, z->img_comp[n].w2, data + 64);
+               }
+            }
+            for (; i < w; ++i) {
                short *data = z->img_comp[n].coeff + 64 * (i + j * z->img_comp[n].coeff_w);
                stbi__jpeg_dequantize(data, z->dequant[z->img_comp[n].tq]);
                z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8, z->img_comp[n].w2, data);
@@ -3643,6 +4002,77 @@ static stbi_uc *stbi__resample_row_hv_2_simd(stbi_uc *out, stbi_uc *in_near, stb
 }
 #endif
 
+#ifdef STBI_AVX2
+// the sse2 loop at 16 pixels per iteration. "prev"/"next" need a neighbour
+// from the other 128-bit lane, which permute2x128 + alignr provide.
+STBI__AVX2_TARGET
+static stbi_uc *stbi__resample_row_hv_2_avx2(stbi_uc *out, stbi_uc *in_near, stbi_uc *in_far, int w, int hs)
+{
+   int i=0,t0,t1;
+
+   if (w == 1) {
+      out[0] = out[1] = stbi__div4(3*in_near[0] + in_far[0] + 2);
+      return out;
+   }
+
+   t1 = 3*in_near[0] + in_far[0];
+   for (; i < ((w-1) & ~15); i += 16) {
+      // vertical pass, 3*x + y = 4*x + (y - x)
+      __m256i farw  = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i *) (in_far + i)));
+      __m256i nearw = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i *) (in_near + i)));
+      __m256i diff  = _mm256_sub_epi16(farw, nearw);
+      __m256i nears = _mm256_slli_epi16(nearw, 2);
+      __m256i curr  = _mm256_add_epi16(nears, diff); // current row
+
+      // prev = curr shifted right one pixel with t1 in front, next = curr
+      // shifted left one pixel with the first pixel of the next group behind
+      __m256i lo0  = _mm256_permute2x128_si256(curr, curr, 0x08); // [0, lo]
+      __m256i hi0  = _mm256_permute2x128_si256(curr, curr, 0x81); // [hi, 0]
+      __m256i prv0 = _mm256_alignr_epi8(curr, lo0, 14);
+      __m256i nxt0 = _mm256_alignr_epi8(hi0, curr, 2);
+      __m256i prev = _mm256_insert_epi16(prv0, t1, 0);
+      __m256i next = _mm256_insert_epi16(nxt0, 3*in_near[i+16] + in_far[i+16], 15);
+
+      // horizontal filter, polyphase as in the sse2 version
+      __m256i bias = _mm256_set1_epi16(8);
+      __m256i curs = _mm256_slli_epi16(curr, 2);
+      __m256i prvd = _mm256_sub_epi16(prev, curr);
+      __m256i nxtd = _mm256_sub_epi16(next, curr);
+      __m256i curb = _mm256_add_epi16(curs, bias);
+      __m256i even = _mm256_add_epi16(prvd, curb);
+      __m256i odd  = _mm256_add_epi16(nxtd, curb);
+
+      // interleave even and odd pixels, then undo scaling. unpack and pack are
+      // both per lane, so the two cancel out and the bytes come out in order
+      __m256i int0 = _mm256_unpacklo_epi16(even, odd);
+      __m256i int1 = _mm256_unpackhi_epi16(even, odd);
+      __m256i de0  = _mm256_srli_epi16(int0, 4);
+      __m256i de1  = _mm256_srli_epi16(int1, 4);
+      __m256i outv = _mm256_packus_epi16(de0, de1);
+      _mm256_storeu_si256((__m256i *) (out + i*2), outv);
+
+      // "previous" value for next iter
+      t1 = 3*in_near[i+15] + in_far[i+15];
+   }
+
+   t0 = t1;
+   t1 = 3*in_near[i] + in_far[i];
+   out[i*2] = stbi__div16(3*t1 + t0 + 8);
+
+   for (++i; i < w; ++i) {
+      t0 = t1;
+      t1 = 3*in_near[i]+in_far[i];
+      out[i*2-1] = stbi__div16(3*t0 + t1 + 8);
+      out[i*2  ] = stbi__div16(3*t1 + t0 + 8);
+   }
+   out[w*2-1] = stbi__div4(t1+2);
+
+   STBI_NOTUSED(hs);
+
+   return out;
+}
+#endif
+
 static stbi_uc *stbi__resample_row_generic(stbi_uc *out, stbi_uc *in_near, stbi_uc *in_far, int w, int hs)
 {
    // resample with nearest-neighbor
@@ -3817,13 +4247,92 @@ static void stbi__YCbCr_to_RGB_simd(stbi_uc *out, stbi_uc const *y, stbi_uc cons
 }
 #endif
 
+#ifdef STBI_AVX2
+// the sse2 step == 4 loop at 16 pixels per iteration; the rest of the row,
+// and step == 3, go through the sse2 version.
+STBI__AVX2_TARGET
+static void stbi__YCbCr_to_RGB_avx2(stbi_uc *out, stbi_uc const *y, stbi_uc const *pcb, stbi_uc const *pcr, int count, int step)
+{
+   int i = 0;
+
+   if (step == 4) {
+      __m128i signflip  = _mm_set1_epi8(-0x80);
+      __m256i cr_const0 = _mm256_set1_epi16(   (short) ( 1.40200f*4096.0f+0.5f));
+      __m256i cr_const1 = _mm256_set1_epi16( - (short) ( 0.71414f*4096.0f+0.5f));
+      __m256i cb_const0 = _mm256_set1_epi16( - (short) ( 0.34414f*4096.0f+0.5f));
+      __m256i cb_const1 = _mm256_set1_epi16(   (short) ( 1.77200f*4096.0f+0.5f));
+      __m256i y_bias = _mm256_set1_epi16(128);
+      __m256i xw = _mm256_set1_epi16(255); // alpha channel
+
+      for (; i+15 < count; i += 16) {
+         // load
+         __m128i y_bytes = _mm_loadu_si128((__m128i *) (y+i));
+         __m128i cr_bytes = _mm_loadu_si128((__m128i *) (pcr+i));
+         __m128i cb_bytes = _mm_loadu_si128((__m128i *) (pcb+i));
+         __m128i cr_biased = _mm_xor_si128(cr_bytes, signflip); // -128
+         __m128i cb_biased = _mm_xor_si128(cb_bytes, signflip); // -128
+
+         // widen to short as (y << 8) + 128, cr << 8, cb << 8
+         __m256i yw  = _mm256_or_si256(_mm256_slli_epi16(_mm256_cvtepu8_epi16(y_bytes), 8), y_bias);
+         __m256i crw = _mm256_slli_epi16(_mm256_cvtepu8_epi16(cr_biased), 8);
+         __m256i cbw = _mm256_slli_epi16(_mm256_cvtepu8_epi16(cb_biased), 8);
+
+         // color transform
+         __m256i yws = _mm256_srli_epi16(yw, 4);
+         __m256i cr0 = _mm256_mulhi_epi16(cr_const0, crw);
+         __m256i cb0 = _mm256_mulhi_epi16(cb_const0, cbw);
+         __m256i cb1 = _mm256_mulhi_epi16(cbw, cb_const1);
+         __m256i cr1 = _mm256_mulhi_epi16(crw, cr_const1);
+         __m256i rws = _mm256_add_epi16(cr0, yws);
+         __m256i gwt = _mm256_add_epi16(cb0, yws);
+         __m256i bws = _mm256_add_epi16(yws, cb1);
+         __m256i gws = _mm256_add_epi16(gwt, cr1);
+
+         // descale
+         __m256i rw = _mm256_srai_epi16(rws, 4);
+         __m256i bw = _mm256_srai_epi16(bws, 4);
+         __m256i gw = _mm256_srai_epi16(gws, 4);
+
+         // back to byte, set up for transpose
+         __m256i brb = _mm256_packus_epi16(rw, bw);
+         __m256i gxb = _mm256_packus_epi16(gw, xw);
+
+         // transpose to interleave channels; the low lane ends up with pixels
+         // 0-3 and 8-11, the high lane with 4-7 and 12-15
+         __m256i t0 = _mm256_unpacklo_epi8(brb, gxb);
+         __m256i t1 = _mm256_unpackhi_epi8(brb, gxb);
+         __m256i o0 = _mm256_unpacklo_epi16(t0, t1);
+         __m256i o1 = _mm256_unpackhi_epi16(t0, t1);
+
+         // store
+         _mm256_storeu_si256((__m256i *) (out + 0), _mm256_permute2x128_si256(o0, o1, 0x20));
+         _mm256_storeu_si256((__m256i *) (out + 32), _mm256_permute2x128_si256(o0, o1, 0x31));
+         out += 64;
+      }
+   }
+
+   stbi__YCbCr_to_RGB_simd(out, y+i, pcb+i, pcr+i, count-i, step);
+}
+#endif
+
+static int stbi__jpeg_simd_limit = 2;
+
+STBIDEF void stbi_jpeg_set_simd_limit(int level)
+{
+   stbi__jpeg_simd_limit = level;
+}
+
 // set up the kernels
 static void stbi__setup_jpeg(stbi__jpeg *j)
 {
    j->idct_block_kernel = stbi__idct_block;
+   j->idct_block2_kernel = NULL;
    j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_row;
    j->resample_row_hv_2_kernel = stbi__resample_row_hv_2;
 
+   if (stbi__jpeg_simd_limit < 1)
+      return;
+
 #ifdef STBI_SSE2
    if (stbi__sse2_available()) {
       j->idct_block_kernel = stbi__idct_simd;
@@ -3832,6 +4341,14 @@ static void stbi__setup_jpeg(stbi__jpeg *j)
    }
 #endif
 
+#ifdef STBI_AVX2
+   if (stbi__jpeg_simd_limit >= 2 && stbi__avx2_available()) {
+      j->idct_block2_kernel = stbi__idct_avx2_x2;
+      j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_avx2;
+      j->resample_row_hv_2_kernel = stbi__resample_row_hv_2_avx2;
+   }
+#endif
+
 #ifdef STBI_NEON
    j->idct_block_kernel = stbi__idct_simd;
    j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_simd;
@@ -3891,7 +4408,7 @@ static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp
    {
       int k;
       unsigned int i,j;
-      stbi_uc *output;
+      stbi_uc *output, *scratch = NULL;
       stbi_uc *coutput[4] = { NULL, NULL, NULL, NULL };
 
       stbi__resample res_comp[4];
@@ -3918,13 +4435,30 @@ static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp
          else                               r->resample = stbi__resample_row_generic;
       }
 
-      // can't error after this so, this is safe
-      output = (stbi_uc *) stbi__malloc_mad3(n, z->s->img_x, z->s->img_y, 1);
+      // can't error after this so, this is safe; write into the caller's buffer
+      // when it holds exactly the requested layout
+      if (z->s->dest && n == req_comp && (size_t) n * z->s->img_x * z->s->img_y <= z->s->dest_size)
+         output = z->s->dest;
+      else
+         output = (stbi_uc *) stbi__malloc_mad3(n, z->s->img_x, z->s->img_y, 1);
       if (!output) { stbi__cleanup_jpeg(z); return stbi__errpuc("outofmem", "Out of memory"); }
 
-      // now go ahead and resample
+      // some 1- and 3-channel writers store a pad byte past the last pixel, which
+      // lands on the next row in memory; when that row is already written
+      // (flipping) or is past the caller's buffer, assemble rows in a scratch line
+      if ((n & 1) && (z->s->flip_rows || output == z->s->dest)) {
+         scratch = (stbi_uc *) stbi__malloc_mad2(n, z->s->img_x, 1);
+         if (!scratch) {
+            if (output != z->s->dest) STBI_FREE(output);
+            stbi__cleanup_jpeg(z);
+            return stbi__errpuc("outofmem", "Out of memory");
+         }
+      }
+
+      // now go ahead and resample, storing rows bottom-up if a flip was requested
       for (j=0; j < z->s->img_y; ++j) {
-         stbi_uc *out = output + n * z->s->img_x * j;
+         stbi_uc *row = output + n * z->s->img_x * (z->s->flip_rows ? z->s->img_y - 1 - j : j);
+         stbi_uc *out = scratch ? scratch : row;
          for (k=0; k < decode_n; ++k) {
             stbi__resample *r = &res_comp[k];
             int y_bot = r->ystep >= (r->vs >> 1);
@@ -4016,7 +4550,10 @@ static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp
                   for (i=0; i < z->s->img_x; ++i) { *out++ = y[i]; *out++ = 255; }
             }
          }
+         if (scratch)
+            memcpy(row, scratch, n * z->s->img_x);
       }
+      STBI_FREE(scratch);
       stbi__cleanup_jpeg(z);
       *out_x = z->s->img_x;
       *out_y = z->s->img_y;
@@ -4031,10 +4568,10 @@ static void *stbi__jpeg_load(stbi__context *s, int *x, int *y, int *comp, int re
    stbi__jpeg* j = (stbi__jpeg*) stbi__malloc(sizeof(stbi__jpeg));
    if (!j) return stbi__errpuc("outofmem", "Out of memory");
    memset(j, 0, sizeof(stbi__jpeg));
-   STBI_NOTUSED(ri);
    j->s = s;
    stbi__setup_jpeg(j);
    result = load_jpeg_image(j, x,y,comp,req_comp);
+   ri->flipped = s->flip_rows;
    STBI_FREE(j);
    return result;
 }
@@ -4092,6 +4629,24 @@ static int stbi__jpeg_info(stbi__context *s, int *x, int *y, int *comp)
 #define STBI__ZFAST_MASK  ((1 << STBI__ZFAST_BITS) - 1)
 #define STBI__ZNSYMS 288 // number of symbols in literal/length alphabet
 
+// second-level tables used by the 64-bit inner loop in stbi__parse_huffman_block;
+// the literal/length table resolves up to two literals, or a length with its base
+// and extra-bit count, per lookup
+#define STBI__ZLFAST_BITS  11
+#define STBI__ZLFAST_MASK  ((1 << STBI__ZLFAST_BITS) - 1)
+#define STBI__ZDFAST_BITS  10
+#define STBI__ZDFAST_MASK  ((1 << STBI__ZDFAST_BITS) - 1)
+// the inner loop only runs while this much output space and input remain, so a
+// maximal match plus the overlapping 16-byte copy tail never needs a bounds check
+#define STBI__ZFAST_OUT_MARGIN  (258 + 32)
+#define STBI__ZFAST_IN_MARGIN   16
+
+#if defined(_MSC_VER)
+typedef unsigned __int64 stbi__uint64;
+#else
+typedef unsigned long long stbi__uint64;
+#endif
+
 // zlib-style huffman encoding
 // (jpegs packs from left, zlib from right, so can't share code)
 typedef struct
@@ -4187,6 +4742,13 @@ typedef struct
    int   z_expandable;
 
    stbi__zhuffman z_length, z_distance;
+
+   // literal/length entries: bits 0-7 consumed bits, 8-9 kind (1 literal, 2 length,
+   // 3 end of block), bit 10 second literal present, 11-15 length extra bits,
+   // 16-31 literal bytes or length base; 0 falls back to the slow decoder.
+   // distance entries: bits 0-7 code size, 8-11 extra bits, 16-31 base; 0 is slow.
+   stbi__uint32 zfast_length[1 << STBI__ZLFAST_BITS];
+   stbi__uint32 zfast_distance[1 << STBI__ZDFAST_BITS];
 } stbi__zbuf;
 
 stbi_inline static int stbi__zeof(stbi__zbuf *z)
@@ -4306,11 +4868,220 @@ static const int stbi__zdist_base[32] = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129
 static const int stbi__zdist_extra[32] =
 { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13};
 
+// single-symbol lookup over 'bits' bits: (code size << 16) | symbol, or 0 when the
+// code is longer than the table. sizelist was already validated by stbi__zbuild_huffman.
+static void stbi__zbuild_fast_symbols(stbi__uint32 *table, int bits, const stbi_uc *sizelist, int num)
+{
+   int i, code = 0, next_code[16], sizes[16];
+   memset(sizes, 0, sizeof(sizes));
+   memset(table, 0, sizeof(*table) << bits);
+   for (i=0; i < num; ++i)
+      ++sizes[sizelist[i]];
+   sizes[0] = 0;
+   for (i=1; i < 16; ++i) {
+      next_code[i] = code;
+      code = (code + sizes[i]) << 1;
+   }
+   for (i=0; i < num; ++i) {
+      int s = sizelist[i];
+      if (s) {
+         if (s <= bits) {
+            int j = stbi__bit_reverse(next_code[s], s);
+            while (j < (1 << bits)) {
+               table[j] = ((stbi__uint32) s << 16) | (stbi__uint32) i;
+               j += (1 << s);
+            }
+         }
+         ++next_code[s];
+      }
+   }
+}
+
+static void stbi__zbuild_fast(stbi__zbuf *a, const stbi_uc *lengths, int nlen, const stbi_uc *dists, int ndist)
+{
+   stbi__uint32 single[1 << STBI__ZLFAST_BITS];
+   int i;
+
+   stbi__zbuild_fast_symbols(single, STBI__ZLFAST_BITS, lengths, nlen);
+   for (i=0; i < (1 << STBI__ZLFAST_BITS); ++i) {
+      stbi__uint32 e = single[i], v = 0;
+      if (e) {
+         int s = (int) (e >> 16), sym = (int) (e & 0xffff);
+         if (sym < 256) {
+            // try to pair it with the literal that follows in the remaining bits
+            stbi__uint32 e2 = single[i >> s];
+            int s2 = (int) (e2 >> 16);
+            v = ((stbi__uint32) sym << 16) | (1 << 8) | (stbi__uint32) s;
+            if (e2 && s + s2 <= STBI__ZLFAST_BITS && (e2 & 0xffff) < 256)
+               v = ((stbi__uint32) ((e2 & 0xff) << 8 | sym) << 16) | (1 << 10) | (1 << 8) | (stbi__uint32) (s + s2);
+         } else if (sym == 256) {
+            v = (3 << 8) | (stbi__uint32) s;
+         } else if (sym < 286) {
+            v = ((stbi__uint32) stbi__zlength_base[sym-257] << 16) | ((stbi__uint32) stbi__zlength_extra[sym-257] << 11) | (2 << 8) | (stbi__uint32) s;
+         }
+      }
+      a->zfast_length[i] = v;
+   }
+
+   stbi__zbuild_fast_symbols(a->zfast_distance, STBI__ZDFAST_BITS, dists, ndist);
+   for (i=0; i < (1 << STBI__ZDFAST_BITS); ++i) {
+      stbi__uint32 e = a->zfast_distance[i];
+      if (e) {
+         int sym = (int) (e & 0xffff);
+         a->zfast_distance[i] = sym < 30 ? ((stbi__uint32) stbi__zdist_base[sym] << 16) | ((stbi__uint32) stbi__zdist_extra[sym] << 8) | (e >> 16) : 0;
+      }
+   }
+}
+
+// slow-path decode of a code longer than the fast tables, from the low 16 bits
+// of the bit buffer; returns the symbol and its size, or -1
+static int stbi__zhuffman_decode_bits(stbi__zhuffman *z, unsigned int bits, int *size)
+{
+   int b,s,k;
+   k = stbi__bit_reverse((int) (bits & 0xffff), 16);
+   for (s=1; ; ++s)
+      if (k < z->maxcode[s])
+         break;
+   if (s >= 16) return -1;
+   b = (k >> (16-s)) - z->firstcode[s] + z->firstsymbol[s];
+   if (b >= STBI__ZNSYMS) return -1;
+   if (z->size[b] != s) return -1;
+   *size = s;
+   return z->value[b];
+}
+
+stbi_inline static stbi__uint64 stbi__zload64(const stbi_uc *p)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+   return (stbi__uint64) p[0]       | (stbi__uint64) p[1] <<  8 | (stbi__uint64) p[2] << 16 | (stbi__uint64) p[3] << 24 |
+          (stbi__uint64) p[4] << 32 | (stbi__uint64) p[5] << 40 | (stbi__uint64) p[6] << 48 | (stbi__uint64) p[7] << 56;
+#else
+   stbi__uint64 v;
+   memcpy(&v, p, 8);
+   return v;
+#endif
+}
+
+// copies a match of len bytes from dist bytes back; may write up to 15 bytes past
+// the end of the match, which the caller guarantees are inside the output buffer
+stbi_inline static char *stbi__zcopy_match(char *zout, int len, int dist)
+{
+   char *end = zout + len;
+   const char *p = zout - dist;
+   if (dist >= 16) {
+      do {
+         memcpy(zout, p, 16);
+         zout += 16; p += 16;
+      } while (zout < end);
+   } else if (dist >= 8) {
+      do {
+         memcpy(zout, p, 8);
+         zout += 8; p += 8;
+      } while (zout < end);
+   } else if (dist == 1) { // run of one byte; common in images.
+      stbi__uint64 v = (stbi__uint64) (stbi_uc) *p * 0x0101010101010101ull;
+      do {
+         memcpy(zout, &v, 8);
+         zout += 8;
+      } while (zout < end);
+   } else {
+      do *zout++ = *p++; while (zout < end);
+   }
+   return end;
+}
+
+// decodes symbols with a 64-bit bit buffer refilled a word at a time while both the
+// input and output have room; returns 0 on error, 2 at end of block, 1 to let the
+// byte-wise loop take over near either end
+static int stbi__parse_huffman_fast(stbi__zbuf *a, char **pzout)
+{
+   const stbi_uc *in = a->zbuffer;
+   const stbi_uc *in_limit = a->zbuffer_end - STBI__ZFAST_IN_MARGIN;
+   char *zout = *pzout;
+   char *zout_limit = a->zout_end - STBI__ZFAST_OUT_MARGIN;
+   stbi__uint64 bitbuf = a->code_buffer;
+   int bitcount = a->num_bits;
+   int result = 1;
+
+   while (in < in_limit && zout < zout_limit) {
+      stbi__uint32 e;
+      int len, dist;
+
+      bitbuf |= stbi__zload64(in) << bitcount;
+      in += (63 - bitcount) >> 3;
+      bitcount |= 56;
+
+      e = a->zfast_length[bitbuf & STBI__ZLFAST_MASK];
+      if (!e) {
+         int s, z = stbi__zhuffman_decode_bits(&a->z_length, (unsigned int) bitbuf, &s);
+         if (z < 0 || z >= 286) { result = stbi__err("bad huffman code","Corrupt PNG"); break; }
+         if (z < 256)
+            e = ((stbi__uint32) z << 16) | (1 << 8) | (stbi__uint32) s;
+         else if (z == 256)
+            e = (3 << 8) | (stbi__uint32) s;
+         else
+            e = ((stbi__uint32) stbi__zlength_base[z-257] << 16) | ((stbi__uint32) stbi__zlength_extra[z-257] << 11) | (2 << 8) | (stbi__uint32) s;
+      }
+      bitbuf >>= e & 0xff;
+      bitcount -= e & 0xff;
+
+      if (((e >> 8) & 3) == 1) {
+         zout[0] = (char) (e >> 16);
+         zout[1] = (char) (e >> 24);
+         zout += 1 + ((e >> 10) & 1);
+         continue;
+      }
+      if (((e >> 8) & 3) == 3) {
+         result = 2;
+         break;
+      }
+
+      // at least 41 bits remain: enough for 5 length extra bits, a 15-bit distance
+      // code and 13 distance extra bits without another refill
+      len = (int) (e >> 16) + (int) (bitbuf & ((1u << ((e >> 11) & 31)) - 1));
+      bitbuf >>= (e >> 11) & 31;
+      bitcount -= (e >> 11) & 31;
+
+      e = a->zfast_distance[bitbuf & STBI__ZDFAST_MASK];
+      if (!e) {
+         int s, z = stbi__zhuffman_decode_bits(&a->z_distance, (unsigned int) bitbuf, &s);
+         if (z < 0 || z >= 30) { result = stbi__err("bad huffman code","Corrupt PNG"); break; }
+         e = ((stbi__uint32) stbi__zdist_base[z] << 16) | ((stbi__uint32) stbi__zdist_extra[z] << 8) | (stbi__uint32) s;
+      }
+      bitbuf >>= e & 0xff;
+      bitcount -= e & 0xff;
+      dist = (int) (e >> 16) + (int) (bitbuf & ((1u << ((e >> 8) & 15)) - 1));
+      bitbuf >>= (e >> 8) & 15;
+      bitcount -= (e >> 8) & 15;
+
+      if (zout - a->zout_start < dist) { result = stbi__err("bad dist","Corrupt PNG"); break; }
+      zout = stbi__zcopy_match(zout, len, dist);
+   }
+
+   // hand back whole unread bytes so the byte-wise refill resumes at the right place
+   in -= bitcount >> 3;
+   bitcount &= 7;
+   a->zbuffer = (stbi_uc *) in;
+   a->code_buffer = (stbi__uint32) (bitbuf & ((1u << bitcount) - 1));
+   a->num_bits = bitcount;
+   *pzout = zout;
+   return result;
+}
+
 static int stbi__parse_huffman_block(stbi__zbuf *a)
 {
    char *zout = a->zout;
    for(;;) {
-      int z = stbi__zhuffman_decode(a, &a->z_length);
+      int z;
+      if (a->zbuffer_end - a->zbuffer > STBI__ZFAST_IN_MARGIN && a->zout_end - zout > STBI__ZFAST_OUT_MARGIN) {
+         int r = stbi__parse_huffman_fast(a, &zout);
+         if (r == 0) return 0;
+         if (r == 2) {
+            a->zout = zout;
+            return 1;
+         }
+      }
+      z = stbi__zhuffman_decode(a, &a->z_length);
       if (z < 256) {
          if (z < 0) return stbi__err("bad huffman code","Corrupt PNG"); // error in huffman codes
          if (zout >= a->zout_end) {
@@ -4403,6 +5174,7 @@ static int stbi__compute_huffman_codes(stbi__zbuf *a)
    if (n != ntot) return stbi__err("bad codelengths","Corrupt PNG");
    if (!stbi__zbuild_huffman(&a->z_length, lencodes, hlit)) return 0;
    if (!stbi__zbuild_huffman(&a->z_distance, lencodes+hlit, hdist)) return 0;
+   stbi__zbuild_fast(a, lencodes, hlit, lencodes+hlit, hdist);
    return 1;
 }
 
@@ -4498,6 +5270,7 @@ static int stbi__parse_zlib(stbi__zbuf *a, int parse_header)
             // use fixed code lengths
             if (!stbi__zbuild_huffman(&a->z_length  , stbi__zdefault_length  , STBI__ZNSYMS)) return 0;
             if (!stbi__zbuild_huffman(&a->z_distance, stbi__zdefault_distance,  32)) return 0;
+            stbi__zbuild_fast(a, stbi__zdefault_length, STBI__ZNSYMS, stbi__zdefault_distance, 32);
          } else {
             if (!stbi__compute_huffman_codes(a)) return 0;
          }
@@ -4632,6 +5405,8 @@ typedef struct
    stbi__context *s;
    stbi_uc *idata, *expanded, *out;
    int depth;
+   stbi_uc *dest;  // caller's buffer to unfilter into, when nothing later changes the layout
+   int flipped;
 } stbi__png;
 
 
@@ -4667,6 +5442,246 @@ static int stbi__paeth(int a, int b, int c)
    return t1;
 }
 
+static int stbi__png_simd_limit = 2;
+
+STBIDEF void stbi_png_set_simd_limit(int level)
+{
+   stbi__png_simd_limit = level;
+}
+
+#ifdef STBI_SSE2
+// Unfiltering for 8-bit images with 3 or 4 bytes per pixel. Sub, Avg and Paeth
+// depend on the pixel to the left, so those run one pixel per register with
+// all channels in parallel (Sub on 4-byte pixels uses a prefix sum over 4 or 8
+// pixels instead); Up has no such dependency and runs 16 or 32 bytes at a time.
+// The first pixel of a row starts from a = c = 0, which matches the scalar
+// special cases exactly.
+
+// Pixels move as 4-byte words. With 3-byte pixels the spare byte is
+// overwritten by the next pixel; the last pixel of a row uses exact-size
+// accesses so nothing outside the row is read or written.
+static __m128i stbi__png_load4(const stbi_uc *p)
+{
+   int v;
+   memcpy(&v, p, 4);
+   return _mm_cvtsi32_si128(v);
+}
+
+static void stbi__png_store4(stbi_uc *p, __m128i v)
+{
+   int x = _mm_cvtsi128_si32(v);
+   memcpy(p, &x, 4);
+}
+
+static __m128i stbi__png_load_last(const stbi_uc *p, int bpp)
+{
+   if (bpp == 4) return stbi__png_load4(p);
+   return _mm_cvtsi32_si128(p[0] | (p[1] << 8) | (p[2] << 16));
+}
+
+static void stbi__png_store_last(stbi_uc *p, __m128i v, int bpp)
+{
+   int x = _mm_cvtsi128_si32(v);
+   p[0] = STBI__BYTECAST(x);
+   p[1] = STBI__BYTECAST(x >> 8);
+   p[2] = STBI__BYTECAST(x >> 16);
+   if (bpp == 4) p[3] = STBI__BYTECAST(x >> 24);
+}
+
+static void stbi__png_unfilter_up_sse2(stbi_uc *cur, const stbi_uc *raw, const stbi_uc *prior, int nk)
+{
+   int k = 0;
+   for (; k + 16 <= nk; k += 16) {
+      __m128i x = _mm_loadu_si128((const __m128i *) (raw + k));
+      __m128i b = _mm_loadu_si128((const __m128i *) (prior + k));
+      _mm_storeu_si128((__m128i *) (cur + k), _mm_add_epi8(x, b));
+   }
+   for (; k < nk; ++k)
+      cur[k] = STBI__BYTECAST(raw[k] + prior[k]);
+}
+
+static void stbi__png_unfilter_sub_sse2(stbi_uc *cur, const stbi_uc *raw, int nk, int bpp)
+{
+   __m128i a = _mm_setzero_si128();
+   int last = nk - bpp;
+   int k = 0;
+   if (bpp == 4) {
+      for (; k + 16 <= nk; k += 16) {
+         __m128i x = _mm_loadu_si128((const __m128i *) (raw + k));
+         x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+         x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+         x = _mm_add_epi8(x, a);
+         _mm_storeu_si128((__m128i *) (cur + k), x);
+         a = _mm_shuffle_epi32(x, 0xff);
+      }
+   }
+   for (; k < last; k += bpp) {
+      a = _mm_add_epi8(stbi__png_load4(raw + k), a);
+      stbi__png_store4(cur + k, a);
+   }
+   if (k == last) {
+      a = _mm_add_epi8(stbi__png_load_last(raw + k, bpp), a);
+      stbi__png_store_last(cur + k, a, bpp);
+   }
+}
+
+static __m128i stbi__png_avg_px(__m128i a, __m128i b, __m128i x)
+{
+   // pavgb rounds up; drop the carry to get floor((a+b)/2)
+   __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1)));
+   return _mm_add_epi8(x, avg);
+}
+
+static void stbi__png_unfilter_avg_sse2(stbi_uc *cur, const stbi_uc *raw, const stbi_uc *prior, int nk, int bpp)
+{
+   __m128i a = _mm_setzero_si128();
+   int last = nk - bpp;
+   int k;
+   for (k = 0; k < last; k += bpp) {
+      a = stbi__png_avg_px(a, stbi__png_load4(prior + k), stbi__png_load4(raw + k));
+      stbi__png_store4(cur + k, a);
+   }
+   a = stbi__png_avg_px(a, stbi__png_load_last(prior + last, bpp), stbi__png_load_last(raw + last, bpp));
+   stbi__png_store_last(cur + last, a, bpp);
+}
+
+static __m128i stbi__png_abs_epi16(__m128i x)
+{
+   return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+static __m128i stbi__png_select(__m128i mask, __m128i a, __m128i b)
+{
+   return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// a, b, c and x are 16-bit lanes; returns the new a
+static __m128i stbi__png_paeth_px(__m128i a, __m128i b, __m128i c, __m128i x)
+{
+   // with p = a + b - c: |p-a| = |b-c|, |p-b| = |a-c|, |p-c| = |(b-c) + (a-c)|
+   __m128i pa = _mm_sub_epi16(b, c);
+   __m128i pb = _mm_sub_epi16(a, c);
+   __m128i pc = stbi__png_abs_epi16(_mm_add_epi16(pa, pb));
+   __m128i smallest, pred;
+   pa = stbi__png_abs_epi16(pa);
+   pb = stbi__png_abs_epi16(pb);
+   smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+   // ties prefer a, then b, as in the PNG spec
+   pred = stbi__png_select(_mm_cmpeq_epi16(smallest, pb), b, c);
+   pred = stbi__png_select(_mm_cmpeq_epi16(smallest, pa), a, pred);
+   // high bytes are zero, so a byte add wraps each channel without a mask
+   return _mm_add_epi8(pred, x);
+}
+
+static void stbi__png_unfilter_paeth_sse2(stbi_uc *cur, const stbi_uc *raw, const stbi_uc *prior, int nk, int bpp)
+{
+   __m128i zero = _mm_setzero_si128();
+   __m128i a = zero, b, c = zero;
+   int last = nk - bpp;
+   int k;
+   for (k = 0; k < last; k += bpp) {
+      b = _mm_unpacklo_epi8(stbi__png_load4(prior + k), zero);
+      a = stbi__png_paeth_px(a, b, c, _mm_unpacklo_epi8(stbi__png_load4(raw + k), zero));
+      stbi__png_store4(cur + k, _mm_packus_epi16(a, a));
+      c = b;
+   }
+   b = _mm_unpacklo_epi8(stbi__png_load_last(prior + last, bpp), zero);
+   a = stbi__png_paeth_px(a, b, c, _mm_unpacklo_epi8(stbi__png_load_last(raw + last, bpp), zero));
+   stbi__png_store_last(cur + last, _mm_packus_epi16(a, a), bpp);
+}
+
+#ifdef STBI_AVX2
+STBI__AVX2_TARGET
+static void stbi__png_unfilter_up_avx2(stbi_uc *cur, const stbi_uc *raw, const stbi_uc *prior, int nk)
+{
+   int k = 0;
+   for (; k + 32 <= nk; k += 32) {
+      __m256i x = _mm256_loadu_si256((const __m256i *) (raw + k));
+      __m256i b = _mm256_loadu_si256((const __m256i *) (prior + k));
+      _mm256_storeu_si256((__m256i *) (cur + k), _mm256_add_epi8(x, b));
+   }
+   stbi__png_unfilter_up_sse2(cur + k, raw + k, prior + k, nk - k);
+}
+
+STBI__AVX2_TARGET
+static void stbi__png_unfilter_sub4_avx2(stbi_uc *cur, const stbi_uc *raw, int nk)
+{
+   __m256i a = _mm256_setzero_si256();
+   __m256i last_low = _mm256_set1_epi32(3);
+   __m256i last_high = _mm256_set1_epi32(7);
+   int k = 0;
+   for (; k + 32 <= nk; k += 32) {
+      __m256i x = _mm256_loadu_si256((const __m256i *) (raw + k));
+      // prefix sum inside each 128-bit lane, then carry the low lane's last pixel up
+      x = _mm256_add_epi8(x, _mm256_slli_si256(x, 4));
+      x = _mm256_add_epi8(x, _mm256_slli_si256(x, 8));
+      x = _mm256_add_epi8(x, _mm256_blend_epi32(_mm256_setzero_si256(), _mm256_permutevar8x32_epi32(x, last_low), 0xf0));
+      x = _mm256_add_epi8(x, a);
+      _mm256_storeu_si256((__m256i *) (cur + k), x);
+      a = _mm256_permutevar8x32_epi32(x, last_high);
+   }
+   if (k < nk) {
+      // finish the row from the last pixel written
+      __m128i p = k > 0 ? stbi__png_load4(cur + k - 4) : _mm_setzero_si128();
+      for (; k < nk; k += 4) {
+         p = _mm_add_epi8(stbi__png_load4(raw + k), p);
+         stbi__png_store4(cur + k, p);
+      }
+   }
+}
+#endif
+
+static int stbi__png_simd_level(void)
+{
+   static int detected = -1;
+   if (detected < 0) {
+#ifdef STBI_AVX2
+      detected = stbi__avx2_available() ? 2 : 1;
+#else
+      detected = 1;
+#endif
+   }
+   return detected < stbi__png_simd_limit ? detected : stbi__png_simd_limit;
+}
+
+// returns 1 if the row was unfiltered here, 0 to fall back to the scalar loops
+static int stbi__png_unfilter_simd(int filter, stbi_uc *cur, const stbi_uc *raw, const stbi_uc *prior, int nk, int filter_bytes)
+{
+   int level = stbi__png_simd_level();
+   if (level == 0 || (filter_bytes != 3 && filter_bytes != 4))
+      return 0;
+
+   switch (filter) {
+   case STBI__F_sub:
+#ifdef STBI_AVX2
+      if (level >= 2 && filter_bytes == 4) {
+         stbi__png_unfilter_sub4_avx2(cur, raw, nk);
+         return 1;
+      }
+#endif
+      stbi__png_unfilter_sub_sse2(cur, raw, nk, filter_bytes);
+      return 1;
+   case STBI__F_up:
+#ifdef STBI_AVX2
+      if (level >= 2) {
+         stbi__png_unfilter_up_avx2(cur, raw, prior, nk);
+         return 1;
+      }
+#endif
+      stbi__png_unfilter_up_sse2(cur, raw, prior, nk);
+      return 1;
+   case STBI__F_avg:
+      stbi__png_unfilter_avg_sse2(cur, raw, prior, nk, filter_bytes);
+      return 1;
+   case STBI__F_paeth:
+      stbi__png_unfilter_paeth_sse2(cur, raw, prior, nk, filter_bytes);
+      return 1;
+   default:
+      return 0;
+   }
+}
+#endif // STBI_SSE2
+
 static const stbi_uc stbi__depth_scale_table[9] = { 0, 0xff, 0x55, 0, 0x11, 0,0,0, 0x01 };
 
 // adds an extra all-255 alpha channel
@@ -4693,7 +5708,7 @@ static void stbi__create_png_alpha_expand8(stbi_uc *dest, stbi_uc *src, stbi__ui
 }
 
 // create the png data from post-deflated data
-static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 raw_len, int out_n, stbi__uint32 x, stbi__uint32 y, int depth, int color)
+static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 raw_len, int out_n, stbi__uint32 x, stbi__uint32 y, int depth, int color, int flip)
 {
    int bytes = (depth == 16 ? 2 : 1);
    stbi__context *s = a->s;
@@ -4709,7 +5724,10 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
    int width = x;
 
    STBI_ASSERT(out_n == s->img_n || out_n == s->img_n+1);
-   a->out = (stbi_uc *) stbi__malloc_mad3(x, y, output_bytes, 0); // extra bytes to write off the end into
+   if (a->dest)
+      a->out = a->dest;
+   else
+      a->out = (stbi_uc *) stbi__malloc_mad3(x, y, output_bytes, 0); // extra bytes to write off the end into
    if (!a->out) return stbi__err("outofmem", "Out of memory");
 
    // note: error exits here don't need to clean up a->out individually,
@@ -4738,7 +5756,7 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
       // cur/prior filter buffers alternate
       stbi_uc *cur = filter_buf + (j & 1)*img_width_bytes;
       stbi_uc *prior = filter_buf + (~j & 1)*img_width_bytes;
-      stbi_uc *dest = a->out + stride*j;
+      stbi_uc *dest = a->out + stride*(flip ? y-1-j : j); // rows are unfiltered in a side buffer, so any order works
       int nk = width * filter_bytes;
       int filter = *raw++;
 
@@ -4752,6 +5770,11 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
       if (j == 0) filter = first_row_filter[filter];
 
       // perform actual filtering
+#ifdef STBI_SSE2
+      if (depth == 8 && stbi__png_unfilter_simd(filter, cur, raw, prior, nk, filter_bytes))
+         ; // handled by the SSE2/AVX2 kernels
+      else
+#endif
       switch (filter) {
       case STBI__F_none:
          memcpy(cur, raw, nk);
@@ -4864,8 +5887,10 @@ static int stbi__create_png_image(stbi__png *a, stbi_uc *image_data, stbi__uint3
    int out_bytes = out_n * bytes;
    stbi_uc *final;
    int p;
-   if (!interlaced)
-      return stbi__create_png_image_raw(a, image_data, image_data_len, out_n, a->s->img_x, a->s->img_y, depth, color);
+   if (!interlaced) {
+      a->flipped = a->s->flip_rows;
+      return stbi__create_png_image_raw(a, image_data, image_data_len, out_n, a->s->img_x, a->s->img_y, depth, color, a->flipped);
+   }
 
    // de-interlacing
    final = (stbi_uc *) stbi__malloc_mad3(a->s->img_x, a->s->img_y, out_bytes, 0);
@@ -4881,7 +5906,7 @@ static int stbi__create_png_image(stbi__png *a, stbi_uc *image_data, stbi__uint3
       y = (a->s->img_y - yorig[p] + yspc[p]-1) / yspc[p];
       if (x && y) {
          stbi__uint32 img_len = ((((a->s->img_n * x * depth) + 7) >> 3) + 1) * y;
-         if (!stbi__create_png_image_raw(a, image_data, image_data_len, out_n, x, y, depth, color)) {
+         if (!stbi__create_png_image_raw(a, image_data, image_data_len, out_n, x, y, depth, color, 0)) {
             STBI_FREE(final);
             return 0;
          }
@@ -5201,9 +6226,22 @@ static int stbi__parse_png_file(stbi__png *z, int scan, int req_comp)
             if (first) return stbi__err("first not IHDR", "Corrupt PNG");
             if (scan != STBI__SCAN_load) return 1;
             if (z->idata == NULL) return stbi__err("no IDAT","Corrupt PNG");
-            // initial guess for decoded data size to avoid unnecessary reallocs
-            bpl = (s->img_x * z->depth + 7) / 8; // bytes per line, per component
-            raw_len = bpl * s->img_y * s->img_n /* pixels */ + s->img_y /* filter mode per row */;
+            // exact decoded data size (per interlace pass) so the inflater never reallocs
+            if (interlace) {
+               static const int xorig[] = { 0,4,0,2,0,1,0 }, yorig[] = { 0,0,4,0,2,0,1 };
+               static const int xspc[]  = { 8,8,4,4,2,2,1 }, yspc[]  = { 8,8,8,4,4,2,2 };
+               int p;
+               raw_len = 0;
+               for (p=0; p < 7; ++p) {
+                  stbi__uint32 px = (s->img_x - xorig[p] + xspc[p]-1) / xspc[p];
+                  stbi__uint32 py = (s->img_y - yorig[p] + yspc[p]-1) / yspc[p];
+                  if (px && py)
+                     raw_len += (((s->img_n * px * z->depth) + 7) / 8 + 1) * py;
+               }
+            } else {
+               bpl = (s->img_x * z->depth + 7) / 8; // bytes per line, per component
+               raw_len = bpl * s->img_y * s->img_n /* pixels */ + s->img_y /* filter mode per row */;
+            }
             z->expanded = (stbi_uc *) stbi_zlib_decode_malloc_guesssize_headerflag((char *) z->idata, ioff, raw_len, (int *) &raw_len, !is_iphone);
             if (z->expanded == NULL) return 0; // zlib should set error
             STBI_FREE(z->idata); z->idata = NULL;
@@ -5211,6 +6249,12 @@ static int stbi__parse_png_file(stbi__png *z, int scan, int req_comp)
                s->img_out_n = s->img_n+1;
             else
                s->img_out_n = s->img_n;
+            // the remaining steps work in place, so unfilter straight into the
+            // caller's buffer unless the image needs a new one (palette, 16-bit,
+            // format conversion, de-interlacing)
+            if (s->dest && !interlace && !pal_img_n && z->depth <= 8 && s->img_out_n == req_comp
+                && (size_t) s->img_x * s->img_y * req_comp <= s->dest_size)
+               z->dest = s->dest;
             if (!stbi__create_png_image(z, z->expanded, raw_len, s->img_out_n, z->depth, color, interlace)) return 0;
             if (has_trans) {
                if (z->depth == 16) {
@@ -5273,6 +6317,7 @@ static void *stbi__do_png(stbi__png *p, int *x, int *y, int *n, int req_comp, st
          return stbi__errpuc("bad bits_per_channel", "PNG not supported: unsupported color depth");
       result = p->out;
       p->out = NULL;
+      ri->flipped = p->flipped;
       if (req_comp && req_comp != p->s->img_out_n) {
          if (ri->bits_per_channel == 8)
             result = stbi__convert_format((unsigned char *) result, p->s->img_out_n, req_comp, p->s->img_x, p->s->img_y);
@@ -5285,7 +6330,8 @@ static void *stbi__do_png(stbi__png *p, int *x, int *y, int *n, int req_comp, st
       *y = p->s->img_y;
       if (n) *n = p->s->img_n;
    }
-   STBI_FREE(p->out);      p->out      = NULL;
+   if (p->out != p->dest) STBI_FREE(p->out);
+   p->out = NULL;
    STBI_FREE(p->expanded); p->expanded = NULL;
    STBI_FREE(p->idata);    p->idata    = NULL;
 
@@ -5296,6 +6342,8 @@ static void *stbi__png_load(stbi__context *s, int *x, int *y, int *comp, int req
 {
    stbi__png p;
    p.s = s;
+   p.dest = NULL;
+   p.flipped = 0;
    return stbi__do_png(&p, x,y,comp,req_comp, ri);
 }
 
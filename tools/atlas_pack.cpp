@@ -0,0 +1,345 @@
+// Packs sprites into a single atlas image and writes the matching UV table.
+//
+//   atlas_pack [--padding N] [--max-size S] [--table-name NAME] <atlas.png> <atlas.h> <images...>
+//
+// Sprites are placed with a bottom-left skyline packer. Each sprite gets N
+// pixels of padding filled by extruding its border, so linear filtering never
+// samples a neighbour. Sprite names are the image file names without
+// directory and extension, e.g.
+//   atlas_pack res/atlas.png CellAtlas.h res/*.png
+// The header defines an AtlasSprite table (see TextureAtlas.h) keyed by name.
+
+#include "../ImageLoader.h"
+#include "../stb_image.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct Sprite
+{
+    std::string Name;
+    int Width = 0, Height = 0;
+    std::vector<unsigned char> Pixels;
+    int X = 0, Y = 0;
+};
+
+struct SkylineNode
+{
+    int X, Y, Width;
+};
+
+class SkylinePacker
+{
+private:
+    int m_Width, m_Height;
+    std::vector<SkylineNode> m_Skyline;
+
+    // lowest y at which a width x height rect fits starting at node index, or -1
+    int Fit(size_t index, int width, int height) const
+    {
+        int x = m_Skyline[index].X;
+        if (x + width > m_Width)
+            return -1;
+        int y = 0;
+        int remaining = width;
+        for (size_t i = index; remaining > 0; i++)
+        {
+            if (i == m_Skyline.size())
+                return -1;
+            y = std::max(y, m_Skyline[i].Y);
+            if (y + height > m_Height)
+                return -1;
+            remaining -= m_Skyline[i].Width;
+        }
+        return y;
+    }
+public:
+    SkylinePacker(int width, int height)
+        : m_Width(width), m_Height(height), m_Skyline{ { 0, 0, width } } { }
+
+    bool Insert(int width, int height, int& outX, int& outY)
+    {
+        int bestY = -1, bestWidth = 0;
+        size_t bestIndex = 0;
+        for (size_t i = 0; i < m_Skyline.size(); i++)
+        {
+            int y = Fit(i, width, height);
+            if (y < 0)
+                continue;
+            if (bestY < 0 || y + height < bestY + height
+                || (y == bestY && m_Skyline[i].Width < bestWidth))
+            {
+                bestY = y;
+                bestIndex = i;
+                bestWidth = m_Skyline[i].Width;
+            }
+        }
+        if (bestY < 0)
+            return false;
+
+        outX = m_Skyline[bestIndex].X;
+        outY = bestY;
+
+        // raise the skyline under the new rect and trim the nodes it covers
+        m_Skyline.insert(m_Skyline.begin() + bestIndex, { outX, outY + height, width });
+        for (size_t i = bestIndex + 1; i < m_Skyline.size(); )
+        {
+            int shadowEnd = m_Skyline[i - 1].X + m_Skyline[i - 1].Width;
+            if (m_Skyline[i].X >= shadowEnd)
+                break;
+            int shrink = shadowEnd - m_Skyline[i].X;
+            m_Skyline[i].X += shrink;
+            m_Skyline[i].Width -= shrink;
+            if (m_Skyline[i].Width > 0)
+                break;
+            m_Skyline.erase(m_Skyline.begin() + i);
+        }
+        for (size_t i = 0; i + 1 < m_Skyline.size(); )
+        {
+            if (m_Skyline[i].Y == m_Skyline[i + 1].Y)
+            {
+                m_Skyline[i].Width += m_Skyline[i + 1].Width;
+                m_Skyline.erase(m_Skyline.begin() + i + 1);
+            }
+            else
+                i++;
+        }
+        return true;
+    }
+};
+
+static uint32_t Crc32(const unsigned char* data, size_t size, uint32_t crc = 0)
+{
+    static uint32_t table[256];
+    if (table[1] == 0)
+    {
+        for (uint32_t n = 0; n < 256; n++)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void PutBigEndian(std::vector<unsigned char>& out, uint32_t value)
+{
+    out.push_back((unsigned char)(value >> 24));
+    out.push_back((unsigned char)(value >> 16));
+    out.push_back((unsigned char)(value >> 8));
+    out.push_back((unsigned char)value);
+}
+
+static void WriteChunk(std::ofstream& file, const char* type, const std::vector<unsigned char>& data)
+{
+    std::vector<unsigned char> chunk;
+    PutBigEndian(chunk, (uint32_t)data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    PutBigEndian(chunk, Crc32(chunk.data() + 4, chunk.size() - 4));
+    file.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+}
+
+// RGBA8 PNG with stored (uncompressed) deflate blocks: no zlib dependency, and
+// the atlas is meant to be packed into assets.pak pre-decoded anyway
+static bool WritePng(const std::string& path, const std::vector<unsigned char>& rgba, int width, int height)
+{
+    std::vector<unsigned char> raw;
+    raw.reserve((size_t)(width * 4 + 1) * height);
+    for (int y = 0; y < height; y++)
+    {
+        raw.push_back(0);
+        const unsigned char* row = rgba.data() + (size_t)y * width * 4;
+        raw.insert(raw.end(), row, row + (size_t)width * 4);
+    }
+
+    std::vector<unsigned char> zlib = { 0x78, 0x01 };
+    for (size_t offset = 0; offset < raw.size() || offset == 0; )
+    {
+        size_t length = std::min<size_t>(65535, raw.size() - offset);
+        bool last = offset + length == raw.size();
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back((unsigned char)length);
+        zlib.push_back((unsigned char)(length >> 8));
+        zlib.push_back((unsigned char)~length);
+        zlib.push_back((unsigned char)(~length >> 8));
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+        offset += length;
+        if (last)
+            break;
+    }
+    uint32_t a = 1, b = 0;
+    for (unsigned char c : raw)
+    {
+        a = (a + c) % 65521;
+        b = (b + a) % 65521;
+    }
+    PutBigEndian(zlib, (b << 16) | a);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+    static const unsigned char signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+    file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+    std::vector<unsigned char> header;
+    PutBigEndian(header, (uint32_t)width);
+    PutBigEndian(header, (uint32_t)height);
+    header.insert(header.end(), { 8, 6, 0, 0, 0 }); // 8-bit RGBA, no interlace
+    WriteChunk(file, "IHDR", header);
+    WriteChunk(file, "IDAT", zlib);
+    WriteChunk(file, "IEND", {});
+    return (bool)file;
+}
+
+static bool Pack(std::vector<Sprite>& sprites, int width, int height, int padding)
+{
+    SkylinePacker packer(width, height);
+    for (Sprite& sprite : sprites)
+    {
+        int x, y;
+        if (!packer.Insert(sprite.Width + 2 * padding, sprite.Height + 2 * padding, x, y))
+            return false;
+        sprite.X = x + padding;
+        sprite.Y = y + padding;
+    }
+    return true;
+}
+
+static std::string SpriteName(const std::string& path)
+{
+    size_t slash = path.find_last_of("/\\");
+    std::string name = path.substr(slash == std::string::npos ? 0 : slash + 1);
+    size_t dot = name.find_last_of('.');
+    return dot == std::string::npos ? name : name.substr(0, dot);
+}
+
+int main(int argc, char** argv)
+{
+    int padding = 2;
+    int maxSize = 8192;
+    std::string tableName = "s_AtlasSprites";
+    int arg = 1;
+    for (; arg + 1 < argc && argv[arg][0] == '-' && argv[arg][1] == '-'; arg += 2)
+    {
+        if (std::strcmp(argv[arg], "--padding") == 0)
+            padding = std::atoi(argv[arg + 1]);
+        else if (std::strcmp(argv[arg], "--max-size") == 0)
+            maxSize = std::atoi(argv[arg + 1]);
+        else if (std::strcmp(argv[arg], "--table-name") == 0)
+            tableName = argv[arg + 1];
+        else
+            break;
+    }
+    if (argc - arg < 3)
+    {
+        std::cout << "usage: atlas_pack [--padding N] [--max-size S] [--table-name NAME] <atlas.png> <atlas.h> <images...>" << std::endl;
+        return 1;
+    }
+    std::string imagePath = argv[arg];
+    std::string headerPath = argv[arg + 1];
+
+    std::vector<Sprite> sprites;
+    long long area = 0;
+    for (int i = arg + 2; i < argc; i++)
+    {
+        Sprite sprite;
+        sprite.Name = SpriteName(argv[i]);
+        int channels = 0;
+        unsigned char* pixels = ImageLoader::Load(argv[i], &sprite.Width, &sprite.Height, &channels, 4);
+        if (!pixels)
+        {
+            std::cout << "cannot decode " << argv[i] << ": " << ImageLoader::GetFailureReason() << std::endl;
+            return 1;
+        }
+        sprite.Pixels.assign(pixels, pixels + (size_t)sprite.Width * sprite.Height * 4);
+        stbi_image_free(pixels);
+        area += (long long)(sprite.Width + 2 * padding) * (sprite.Height + 2 * padding);
+        sprites.push_back(std::move(sprite));
+    }
+
+    // tall sprites first keeps the skyline flat
+    std::sort(sprites.begin(), sprites.end(), [](const Sprite& a, const Sprite& b) {
+        return a.Height != b.Height ? a.Height > b.Height : a.Width > b.Width;
+    });
+
+    // double the shorter side, clamped to maxSize, until the page holds the
+    // sprites' area and they pack; the shorter side is below maxSize as
+    // long as either is
+    int width = std::min(64, maxSize), height = width;
+    while ((long long)width * height < area || !Pack(sprites, width, height, padding))
+    {
+        if (width >= maxSize && height >= maxSize)
+        {
+            std::cout << "sprites do not fit in " << maxSize << "x" << maxSize << std::endl;
+            return 1;
+        }
+        int& side = width <= height ? width : height;
+        side = (int)std::min<long long>((long long)side * 2, maxSize);
+    }
+
+    std::vector<unsigned char> atlas((size_t)width * height * 4, 0);
+    for (const Sprite& sprite : sprites)
+    {
+        // copy the sprite and extrude its edges into the padding
+        for (int y = -padding; y < sprite.Height + padding; y++)
+        {
+            int sy = std::min(std::max(y, 0), sprite.Height - 1);
+            for (int x = -padding; x < sprite.Width + padding; x++)
+            {
+                int sx = std::min(std::max(x, 0), sprite.Width - 1);
+                const unsigned char* src = sprite.Pixels.data() + ((size_t)sy * sprite.Width + sx) * 4;
+                unsigned char* dst = atlas.data() + ((size_t)(sprite.Y + y) * width + sprite.X + x) * 4;
+                std::memcpy(dst, src, 4);
+            }
+        }
+    }
+
+    if (!WritePng(imagePath, atlas, width, height))
+    {
+        std::cout << "cannot write " << imagePath << std::endl;
+        return 1;
+    }
+
+    std::ofstream header(headerPath, std::ios::trunc);
+    header << std::setprecision(9);
+    header << "// Generated by tools/atlas_pack.cpp from " << sprites.size() << " sprites. Do not edit.\n"
+           << "#pragma once\n\n#include \"TextureAtlas.h\"\n\n"
+           << "static const char* const " << tableName << "Image = \"" << imagePath << "\";\n"
+           << "static const int " << tableName << "Width = " << width << ";\n"
+           << "static const int " << tableName << "Height = " << height << ";\n\n"
+           << "static const AtlasSprite " << tableName << "[] = {\n";
+    std::sort(sprites.begin(), sprites.end(), [](const Sprite& a, const Sprite& b) { return a.Name < b.Name; });
+    for (const Sprite& sprite : sprites)
+    {
+        // v is flipped to match Texture's bottom-up upload
+        float u0 = (float)sprite.X / width;
+        float u1 = (float)(sprite.X + sprite.Width) / width;
+        float v0 = (float)(height - sprite.Y - sprite.Height) / height;
+        float v1 = (float)(height - sprite.Y) / height;
+        header << "    { \"" << sprite.Name << "\", " << sprite.X << ", " << sprite.Y << ", "
+               << sprite.Width << ", " << sprite.Height << ", { "
+               << u0 << "f, " << v0 << "f, " << u1 << "f, " << v1 << "f } },\n";
+    }
+    header << "};\n\nstatic const unsigned int " << tableName << "Count = " << sprites.size() << ";\n";
+    if (!header)
+    {
+        std::cout << "cannot write " << headerPath << std::endl;
+        return 1;
+    }
+
+    std::cout << "packed " << sprites.size() << " sprites into " << width << "x" << height << std::endl;
+    return 0;
+}
@@ -0,0 +1,238 @@
+// Image decode throughput benchmark.
+//
+//   bench_decode [--iterations N] [--threads T] [--simd-sweep] <images or directories...>
+//
+// Every image (directories are scanned for .png/.jpg/.jpeg/.bmp/.tga) is read
+// into memory once and decoded N times with stbi_load_from_memory, first on
+// the calling thread and then spread over a pool of T threads (default: one
+// per hardware thread). Results are grouped by format: MB/s counts decoded
+// RGBA output bytes, and allocator calls are DecodeArena counts per decode.
+// --simd-sweep repeats the single-threaded run once per PNG/JPEG SIMD level
+// (scalar, SSE2, AVX2).
+
+#include "../DecodeArena.h"
+#include "../ThreadPool.h"
+#include "../stb_image.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+enum class ImageFormat
+{
+    PNG = 0, JPEG, BMP, TGA, OTHER, COUNT
+};
+
+static const char* s_FormatNames[] = { "png", "jpeg", "bmp", "tga", "other" };
+
+struct EncodedImage
+{
+    std::string Path;
+    ImageFormat Format;
+    std::vector<unsigned char> Data;
+};
+
+struct FormatResult
+{
+    double Seconds = 0.0;
+    double Bytes = 0.0;
+    unsigned long long Images = 0;
+    unsigned long long Allocations = 0;
+    unsigned long long Reallocations = 0;
+    unsigned long long HeapCalls = 0;
+};
+
+ImageFormat DetectFormat(const std::string& path, const std::vector<unsigned char>& data)
+{
+    if (data.size() >= 8 && std::memcmp(data.data(), "\x89PNG\r\n\x1a\n", 8) == 0)
+        return ImageFormat::PNG;
+    if (data.size() >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF)
+        return ImageFormat::JPEG;
+    if (data.size() >= 2 && data[0] == 'B' && data[1] == 'M')
+        return ImageFormat::BMP;
+    // TGA has no signature
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == ".tga" ? ImageFormat::TGA : ImageFormat::OTHER;
+}
+
+bool HasImageExtension(const std::filesystem::path& path)
+{
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == ".png" || extension == ".jpg" || extension == ".jpeg"
+        || extension == ".bmp" || extension == ".tga";
+}
+
+bool AddImage(std::vector<EncodedImage>& images, const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.empty())
+    {
+        std::cout << "cannot read " << path << std::endl;
+        return false;
+    }
+    ImageFormat format = DetectFormat(path, data);
+    images.push_back({ path, format, std::move(data) });
+    return true;
+}
+
+// decodes one image and adds its time, output size and arena counts
+bool Decode(const EncodedImage& image, FormatResult& result)
+{
+    DecodeArenaStats before = DecodeArena::Get().GetStats();
+    int width, height, channels;
+    auto start = std::chrono::steady_clock::now();
+    unsigned char* pixels = stbi_load_from_memory(image.Data.data(), (int)image.Data.size(), &width, &height, &channels, 4);
+    result.Seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!pixels)
+    {
+        std::cout << "cannot decode " << image.Path << ": " << stbi_failure_reason() << std::endl;
+        return false;
+    }
+    stbi_image_free(pixels);
+
+    const DecodeArenaStats& after = DecodeArena::Get().GetStats();
+    result.Bytes += (double)width * height * 4;
+    result.Images++;
+    result.Allocations += after.Allocations - before.Allocations;
+    result.Reallocations += after.Reallocations - before.Reallocations;
+    result.HeapCalls += after.HeapCalls - before.HeapCalls;
+    return true;
+}
+
+// wallSeconds > 0 marks a threaded run: decodes overlapped, so each format is
+// charged its share of the wall time rather than its summed decode time
+void PrintResults(const char* label, const FormatResult* results, double wallSeconds)
+{
+    double decodeSeconds = 0.0;
+    for (int i = 0; i < (int)ImageFormat::COUNT; i++)
+        decodeSeconds += results[i].Seconds;
+    double scale = wallSeconds > 0.0 && decodeSeconds > 0.0 ? wallSeconds / decodeSeconds : 1.0;
+
+    for (int i = 0; i < (int)ImageFormat::COUNT; i++)
+    {
+        const FormatResult& result = results[i];
+        if (result.Images == 0)
+            continue;
+        double seconds = result.Seconds * scale;
+        double images = (double)result.Images;
+        std::cout << std::setw(10) << label << " " << std::setw(5) << s_FormatNames[i] << ": "
+                  << result.Bytes / seconds / 1e6 << " MB/s, " << images / seconds << " images/s, "
+                  << result.Allocations / images << " allocs + " << result.Reallocations / images
+                  << " reallocs, " << result.HeapCalls / images << " heap calls per image" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 10;
+    unsigned int threads = 0;
+    bool simdSweep = false;
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-' && argv[arg][1] == '-'; arg++)
+    {
+        if (std::strcmp(argv[arg], "--iterations") == 0 && arg + 1 < argc)
+            iterations = std::atoi(argv[++arg]);
+        else if (std::strcmp(argv[arg], "--threads") == 0 && arg + 1 < argc)
+            threads = (unsigned int)std::atoi(argv[++arg]);
+        else if (std::strcmp(argv[arg], "--simd-sweep") == 0)
+            simdSweep = true;
+        else
+            break;
+    }
+    if (arg >= argc)
+    {
+        std::cout << "usage: bench_decode [--iterations N] [--threads T] [--simd-sweep] <images or directories...>" << std::endl;
+        return 1;
+    }
+
+    std::vector<EncodedImage> images;
+    for (; arg < argc; arg++)
+    {
+        std::error_code error;
+        if (std::filesystem::is_directory(argv[arg], error))
+        {
+            std::vector<std::string> paths;
+            for (const auto& entry : std::filesystem::directory_iterator(argv[arg], error))
+                if (entry.is_regular_file() && HasImageExtension(entry.path()))
+                    paths.push_back(entry.path().string());
+            std::sort(paths.begin(), paths.end());
+            for (const std::string& path : paths)
+                if (!AddImage(images, path))
+                    return 1;
+        }
+        else if (!AddImage(images, argv[arg]))
+        {
+            return 1;
+        }
+    }
+    if (images.empty())
+    {
+        std::cout << "no images found" << std::endl;
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+
+    static const char* levelNames[] = { "scalar", "sse2", "avx2" };
+    int firstLevel = simdSweep ? 0 : 2;
+    for (int level = firstLevel; level < 3; level++)
+    {
+        stbi_png_set_simd_limit(level);
+        stbi_jpeg_set_simd_limit(level);
+        FormatResult results[(int)ImageFormat::COUNT];
+        for (int i = 0; i < iterations; i++)
+            for (const EncodedImage& image : images)
+                if (!Decode(image, results[(int)image.Format]))
+                    return 1;
+        PrintResults(simdSweep ? levelNames[level] : "1 thread", results, 0.0);
+    }
+
+    // every worker accumulates into its own slot; the pool overlaps decodes, so
+    // throughput is rated against wall time
+    ThreadPool pool(threads);
+    std::vector<std::vector<FormatResult>> perTask(images.size(), std::vector<FormatResult>((int)ImageFormat::COUNT));
+    std::atomic<bool> failed(false);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t index = 0; index < images.size(); index++)
+    {
+        pool.Submit([&, index] {
+            const EncodedImage& image = images[index];
+            for (int i = 0; i < iterations && !failed; i++)
+                if (!Decode(image, perTask[index][(int)image.Format]))
+                    failed = true;
+        });
+    }
+    pool.Wait();
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (failed)
+        return 1;
+
+    FormatResult results[(int)ImageFormat::COUNT];
+    for (const std::vector<FormatResult>& task : perTask)
+    {
+        for (int i = 0; i < (int)ImageFormat::COUNT; i++)
+        {
+            results[i].Seconds += task[i].Seconds;
+            results[i].Bytes += task[i].Bytes;
+            results[i].Images += task[i].Images;
+            results[i].Allocations += task[i].Allocations;
+            results[i].Reallocations += task[i].Reallocations;
+            results[i].HeapCalls += task[i].HeapCalls;
+        }
+    }
+    std::string label = std::to_string(pool.GetThreadCount()) + (pool.GetThreadCount() == 1 ? " thread" : " threads");
+    PrintResults(label.c_str(), results, wallSeconds);
+    return 0;
+}
@@ -0,0 +1,93 @@
+// Board generation scaling benchmark.
+//
+//   bench_generate [--iterations N] [--threads T] [width height [mines]]
+//
+// Generates a board (default 10000 x 10000 at expert density, 99 mines per
+// 480 cells) on thread pools of 1, 2, 4, ... up to T threads (default: one
+// per hardware thread) and reports milliseconds per board and the speedup
+// over one thread. Mine placement and neighbor counting both run per band of
+// rows, so the pool only changes where bands run, never the board itself:
+// every pool's board is compared with the single-threaded one. A density
+// sweep then times single-threaded generation from 1% to 99% mines.
+
+#include "../Board.h"
+#include "../CpuFeatures.h"
+#include "../ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    int iterations = 5;
+    unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    int arg = 1;
+    for (; arg + 1 < argc && argv[arg][0] == '-' && argv[arg][1] == '-'; arg += 2)
+    {
+        if (std::strcmp(argv[arg], "--iterations") == 0)
+            iterations = std::atoi(argv[arg + 1]);
+        else if (std::strcmp(argv[arg], "--threads") == 0)
+            maxThreads = (unsigned int)std::max(1, std::atoi(argv[arg + 1]));
+        else
+            break;
+    }
+    int width = argc > arg + 1 ? std::atoi(argv[arg]) : 10000;
+    int height = argc > arg + 1 ? std::atoi(argv[arg + 1]) : 10000;
+    long long mines = argc > arg + 2 ? std::atoll(argv[arg + 2]) : (long long)width * height * 99 / 480;
+    if (width <= 0 || height <= 0 || mines < 0 || iterations <= 0)
+    {
+        std::cout << "usage: bench_generate [--iterations N] [--threads T] [width height [mines]]" << std::endl;
+        return 1;
+    }
+
+    CpuFeatures::Get().Print();
+    Board board(width, height, (int)std::min<long long>(mines, (long long)width * height));
+    std::cout << width << "x" << height << ", " << board.GetMineCount() << " mines" << std::endl;
+    // first touch of the cell and bitboard pages stays out of the timings
+    const uint64_t seed = 12345;
+    board.Generate(seed);
+    MineBitboard reference = board.GetMines();
+
+    std::vector<unsigned int> threadCounts;
+    for (unsigned int threads = 1; threads < maxThreads; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(maxThreads);
+
+    std::cout << std::fixed << std::setprecision(2);
+    double baseline = 0.0;
+    for (unsigned int threads : threadCounts)
+    {
+        ThreadPool pool(threads);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+            board.Generate(seed, &pool);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+        if (threads == 1)
+            baseline = seconds;
+        bool same = true;
+        for (int y = 0; y < height && same; y++)
+            same = std::equal(reference.GetRow(y), reference.GetRow(y) + reference.GetWordsPerRow(), board.GetMines().GetRow(y));
+        std::cout << std::setw(3) << threads << (threads == 1 ? " thread:  " : " threads: ") << seconds * 1e3
+                  << " ms, " << baseline / seconds << "x" << (same ? "" : ", BOARD DIFFERS") << std::endl;
+        if (!same)
+            return 1;
+    }
+
+    for (double density : { 0.01, 0.2, 0.5, 0.9, 0.99 })
+    {
+        Board sweep(width, height, (int)(density * width * height));
+        sweep.Generate(seed);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+            sweep.Generate(seed + i);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+        std::cout << std::setw(4) << (int)(density * 100) << "% mines: " << seconds * 1e3 << " ms" << std::endl;
+    }
+    return 0;
+}
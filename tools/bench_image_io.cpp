@@ -0,0 +1,133 @@
+// Image file input benchmark: stdio (stbi_load) against ImageLoader (a
+// sequential mmap, decoded with stbi_load_from_memory).
+//
+//   bench_image_io [--iterations N] <images...>
+//
+// Each mode runs cold, with the files' pages dropped from the page cache
+// (posix_fadvise DONTNEED) before every load, and warm. Reported per mode:
+// MB/s of file bytes, read() syscalls from /proc/self/io, and page faults.
+// The mmap path adds a fixed open/fstat/mmap/madvise/munmap/close per file
+// that /proc/self/io does not count.
+
+#include "../ImageLoader.h"
+#include "../stb_image.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct IoCounters
+{
+    unsigned long long ReadCalls = 0;
+    long MinorFaults = 0;
+    long MajorFaults = 0;
+};
+
+IoCounters ReadCounters()
+{
+    IoCounters counters;
+    std::ifstream io("/proc/self/io");
+    std::string key;
+    unsigned long long value;
+    while (io >> key >> value)
+    {
+        if (key == "syscr:")
+            counters.ReadCalls = value;
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    counters.MinorFaults = usage.ru_minflt;
+    counters.MajorFaults = usage.ru_majflt;
+    return counters;
+}
+
+void DropFromPageCache(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 10;
+    int arg = 1;
+    if (argc > arg + 1 && std::strcmp(argv[arg], "--iterations") == 0)
+    {
+        iterations = std::atoi(argv[arg + 1]);
+        arg += 2;
+    }
+    if (arg >= argc)
+    {
+        std::cout << "usage: bench_image_io [--iterations N] <images...>" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> paths(argv + arg, argv + argc);
+    double fileBytes = 0.0;
+    for (const std::string& path : paths)
+    {
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0)
+        {
+            std::cout << "cannot stat " << path << std::endl;
+            return 1;
+        }
+        fileBytes += (double)st.st_size;
+    }
+
+    static const char* modeNames[] = { "stdio", "mmap" };
+    std::cout << std::fixed << std::setprecision(1);
+    for (int cold = 1; cold >= 0; cold--)
+    {
+        for (int mode = 0; mode < 2; mode++)
+        {
+            double seconds = 0.0;
+            IoCounters before = ReadCounters();
+            for (int i = 0; i < iterations; i++)
+            {
+                for (const std::string& path : paths)
+                {
+                    if (cold)
+                        DropFromPageCache(path);
+
+                    int width, height, channels;
+                    auto start = std::chrono::steady_clock::now();
+                    unsigned char* pixels = mode == 0
+                        ? stbi_load(path.c_str(), &width, &height, &channels, 4)
+                        : ImageLoader::Load(path, &width, &height, &channels, 4);
+                    seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                    if (!pixels)
+                    {
+                        std::cout << "cannot decode " << path << ": " << stbi_failure_reason() << std::endl;
+                        return 1;
+                    }
+                    stbi_image_free(pixels);
+                }
+            }
+            IoCounters after = ReadCounters();
+
+            double loads = (double)iterations * paths.size();
+            std::cout << (cold ? "cold " : "warm ") << std::setw(5) << modeNames[mode] << ": "
+                      << fileBytes * iterations / seconds / 1e6 << " MB/s, "
+                      << (after.ReadCalls - before.ReadCalls) / loads << " reads/load, "
+                      << (after.MinorFaults - before.MinorFaults) / loads << " minor + "
+                      << (after.MajorFaults - before.MajorFaults) / loads << " major faults/load" << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,137 @@
+// mat4 kernel benchmark: scalar glm against the SSE and AVX/FMA kernels.
+//
+//   bench_matrix [--iterations N]
+//
+// Each operation runs over a working set of 1024 random well-conditioned
+// matrices, N passes per level (levels the CPU lacks are skipped). Reported:
+// nanoseconds per operation and the largest absolute difference from the
+// scalar result, which shows the rounding (and for inverse, formula) change.
+
+#include "../CpuFeatures.h"
+#include "../MatrixKernels.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+static const int s_Count = 1024;
+
+enum class Operation
+{
+    MULTIPLY = 0, MULTIPLY_VECTOR, INVERSE, TRANSPOSE, COUNT
+};
+
+static const char* s_OperationNames[] = { "multiply", "mul vec4", "inverse", "transpose" };
+
+struct Workload
+{
+    std::vector<glm::mat4> A, B, MatrixOut;
+    std::vector<glm::vec4> V, VectorOut;
+};
+
+// runs one pass of op over the working set
+void RunPass(const MatrixKernels& kernels, Operation op, Workload& work)
+{
+    switch (op)
+    {
+    case Operation::MULTIPLY:
+        for (int i = 0; i < s_Count; i++)
+            kernels.Multiply(work.A[i], work.B[i], work.MatrixOut[i]);
+        break;
+    case Operation::MULTIPLY_VECTOR:
+        for (int i = 0; i < s_Count; i++)
+            kernels.MultiplyVector(work.A[i], work.V[i], work.VectorOut[i]);
+        break;
+    case Operation::INVERSE:
+        for (int i = 0; i < s_Count; i++)
+            kernels.Inverse(work.A[i], work.MatrixOut[i]);
+        break;
+    case Operation::TRANSPOSE:
+        for (int i = 0; i < s_Count; i++)
+            kernels.Transpose(work.A[i], work.MatrixOut[i]);
+        break;
+    default:
+        break;
+    }
+}
+
+float MaxDifference(Operation op, const Workload& work, const Workload& reference)
+{
+    float diff = 0.0f;
+    for (int i = 0; i < s_Count; i++)
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            if (op == Operation::MULTIPLY_VECTOR)
+            {
+                diff = std::max(diff, std::fabs(work.VectorOut[i][c] - reference.VectorOut[i][c]));
+                continue;
+            }
+            for (int r = 0; r < 4; r++)
+                diff = std::max(diff, std::fabs(work.MatrixOut[i][c][r] - reference.MatrixOut[i][c][r]));
+        }
+    }
+    return diff;
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 2000;
+    if (argc > 2 && std::strcmp(argv[1], "--iterations") == 0)
+        iterations = std::atoi(argv[2]);
+
+    CpuFeatures::Get().Print();
+
+    // diagonally dominant, so inverses are well defined
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    Workload work;
+    work.A.resize(s_Count);
+    work.B.resize(s_Count);
+    work.V.resize(s_Count);
+    work.MatrixOut.resize(s_Count);
+    work.VectorOut.resize(s_Count);
+    for (int i = 0; i < s_Count; i++)
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            for (int r = 0; r < 4; r++)
+            {
+                work.A[i][c][r] = dist(rng) + (c == r ? 4.0f : 0.0f);
+                work.B[i][c][r] = dist(rng);
+            }
+            work.V[i][c] = dist(rng);
+        }
+    }
+
+    // operations share the output arrays, so keep one scalar result per operation
+    std::vector<Workload> references((int)Operation::COUNT, work);
+    MatrixKernels scalar = MatrixKernels::ForLevel(SimdLevel::SCALAR);
+    for (int op = 0; op < (int)Operation::COUNT; op++)
+        RunPass(scalar, (Operation)op, references[op]);
+
+    std::cout << std::fixed;
+    SimdLevel best = CpuFeatures::Get().GetBestLevel();
+    for (int level = 0; level <= (int)best; level++)
+    {
+        MatrixKernels kernels = MatrixKernels::ForLevel((SimdLevel)level);
+        for (int op = 0; op < (int)Operation::COUNT; op++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; i++)
+                RunPass(kernels, (Operation)op, work);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            std::cout << std::setw(7) << CpuFeatures::GetLevelName(kernels.Level) << " " << std::setw(10) << s_OperationNames[op] << ": "
+                      << std::setprecision(2) << seconds * 1e9 / ((double)iterations * s_Count) << " ns/op, max diff "
+                      << std::setprecision(8) << MaxDifference((Operation)op, work, references[op]) << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+// Neighbor count benchmark for the bitboard mine layer.
+//
+//   bench_neighbors [--iterations N] [width height [density]]
+//
+// Checks MineBitboard::CountNeighbors, scalar and AVX2, against the per-cell
+// routine main.cpp used before (8 bounds-checked lookups per cell) on a set
+// of odd board shapes that exercise the word and row padding, then times all
+// three on one large random board (default 16384 x 16384 at 20% mines).
+// Reports milliseconds per board and cells per nanosecond.
+
+#include "../CpuFeatures.h"
+#include "../MineBitboard.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// the former calculateMemeCounts, over a byte per cell
+void ReferenceCounts(const std::vector<unsigned char>& isMeme, int width, int height, std::vector<unsigned char>& counts)
+{
+    const int dx[] = { -1, -1, -1,  0, 0,  1, 1, 1 };
+    const int dy[] = { -1,  0,  1, -1, 1, -1, 0, 1 };
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            unsigned char count = 0;
+            if (!isMeme[(size_t)y * width + x])
+            {
+                for (int i = 0; i < 8; ++i)
+                {
+                    int nx = x + dx[i];
+                    int ny = y + dy[i];
+                    if (nx >= 0 && nx < width && ny >= 0 && ny < height && isMeme[(size_t)ny * width + nx])
+                        count++;
+                }
+            }
+            counts[(size_t)y * width + x] = count;
+        }
+    }
+}
+
+void FillRandom(MineBitboard& board, std::vector<unsigned char>& isMeme, double density, std::mt19937_64& rng)
+{
+    std::bernoulli_distribution mine(density);
+    for (int y = 0; y < board.GetHeight(); y++)
+    {
+        for (int x = 0; x < board.GetWidth(); x++)
+        {
+            bool m = mine(rng);
+            isMeme[(size_t)y * board.GetWidth() + x] = m;
+            board.Set(x, y, m);
+        }
+    }
+}
+
+size_t CountMismatches(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b)
+{
+    size_t mismatches = 0;
+    for (size_t i = 0; i < a.size(); i++)
+        mismatches += a[i] != b[i];
+    return mismatches;
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 5;
+    int arg = 1;
+    if (argc > arg + 1 && std::strcmp(argv[arg], "--iterations") == 0)
+    {
+        iterations = std::atoi(argv[arg + 1]);
+        arg += 2;
+    }
+    int width = argc > arg + 1 ? std::atoi(argv[arg]) : 16384;
+    int height = argc > arg + 1 ? std::atoi(argv[arg + 1]) : 16384;
+    double density = argc > arg + 2 ? std::atof(argv[arg + 2]) : 0.2;
+    if (width <= 0 || height <= 0 || iterations <= 0)
+    {
+        std::cout << "usage: bench_neighbors [--iterations N] [width height [density]]" << std::endl;
+        return 1;
+    }
+
+    CpuFeatures::Get().Print();
+    std::mt19937_64 rng(42);
+
+    const int shapes[][2] = { { 1, 1 }, { 9, 9 }, { 63, 5 }, { 64, 64 }, { 65, 3 }, { 200, 1 },
+                              { 1, 200 }, { 255, 17 }, { 257, 257 }, { 1000, 777 } };
+    for (const int* shape : shapes)
+    {
+        for (double d : { 0.0, 0.2, 0.8, 1.0 })
+        {
+            MineBitboard board(shape[0], shape[1]);
+            size_t cells = (size_t)shape[0] * shape[1];
+            std::vector<unsigned char> isMeme(cells), expected(cells), scalar(cells), simd(cells);
+            FillRandom(board, isMeme, d, rng);
+            ReferenceCounts(isMeme, shape[0], shape[1], expected);
+            board.CountNeighbors(scalar.data(), shape[0], false);
+            board.CountNeighbors(simd.data(), shape[0], true);
+            size_t mismatches = CountMismatches(expected, scalar) + CountMismatches(expected, simd);
+            if (mismatches)
+            {
+                std::cout << shape[0] << "x" << shape[1] << " at " << d << ": " << mismatches << " wrong counts" << std::endl;
+                return 1;
+            }
+        }
+    }
+    std::cout << "counts match the per-cell routine on " << sizeof(shapes) / sizeof(shapes[0]) << " shapes" << std::endl;
+
+    size_t cells = (size_t)width * height;
+    MineBitboard board(width, height);
+    std::vector<unsigned char> isMeme(cells), expected(cells), counts(cells);
+    FillRandom(board, isMeme, density, rng);
+    std::cout << width << "x" << height << ", " << board.CountMines() << " mines" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+
+    auto start = std::chrono::steady_clock::now();
+    ReferenceCounts(isMeme, width, height, expected);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "   per-cell: " << seconds * 1e3 << " ms, " << cells / seconds / 1e9 << " cells/ns" << std::endl;
+
+    static const char* names[] = { "bitboard", "avx2" };
+    for (int simd = 0; simd < 2; simd++)
+    {
+        if (simd && !CpuFeatures::Get().AVX2)
+            break;
+        std::memset(counts.data(), 0xFF, cells);
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+            board.CountNeighbors(counts.data(), width, simd != 0);
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+        std::cout << std::setw(11) << names[simd] << ": " << seconds * 1e3 << " ms, " << cells / seconds / 1e9
+                  << " cells/ns, " << CountMismatches(expected, counts) << " mismatches" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,113 @@
+// No-guess generator benchmark.
+//
+//   bench_noguess [--boards N] [--threads T] [--candidates C] [width height mines]
+//
+// Generates N no-guess boards (default 20) from consecutive seeds, first
+// click in the middle, at beginner (9 x 9, 10 mines), intermediate (16 x 16,
+// 40), expert (30 x 16, 99) and a large custom size (default 200 x 200 at 12%
+// mines), with candidates tested on a pool of T threads (default: one per
+// hardware thread). Reports the share of candidates the solver accepts and
+// the mean time to a valid board. Every accepted board is checked against a
+// single-threaded search, which must pick the same candidate, and is played
+// once more to make sure it really clears without a guess.
+
+#include "../Board.h"
+#include "../NoGuessGenerator.h"
+#include "../ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+    struct Preset
+    {
+        const char* Name;
+        int Width;
+        int Height;
+        int Mines;
+    };
+}
+
+int main(int argc, char** argv)
+{
+    int boards = 20;
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t maxCandidates = 100000;
+    int arg = 1;
+    for (; arg + 1 < argc && argv[arg][0] == '-' && argv[arg][1] == '-'; arg += 2)
+    {
+        if (std::strcmp(argv[arg], "--boards") == 0)
+            boards = std::atoi(argv[arg + 1]);
+        else if (std::strcmp(argv[arg], "--threads") == 0)
+            threads = (unsigned int)std::max(1, std::atoi(argv[arg + 1]));
+        else if (std::strcmp(argv[arg], "--candidates") == 0)
+            maxCandidates = (size_t)std::max(1, std::atoi(argv[arg + 1]));
+        else
+            break;
+    }
+    Preset presets[] = {
+        { "beginner", 9, 9, 10 },
+        { "intermediate", 16, 16, 40 },
+        { "expert", 30, 16, 99 },
+        { "custom", 200, 200, 4800 },
+    };
+    if (argc > arg + 2)
+    {
+        presets[3].Width = std::atoi(argv[arg]);
+        presets[3].Height = std::atoi(argv[arg + 1]);
+        presets[3].Mines = std::atoi(argv[arg + 2]);
+    }
+    if (boards <= 0 || presets[3].Width <= 0 || presets[3].Height <= 0 || presets[3].Mines < 0)
+    {
+        std::cout << "usage: bench_noguess [--boards N] [--threads T] [--candidates C] [width height mines]" << std::endl;
+        return 1;
+    }
+
+    ThreadPool pool(threads);
+    std::cout << pool.GetThreadCount() << " threads, " << boards << " boards per size, at most " << maxCandidates
+              << " candidates each" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+
+    bool consistent = true;
+    for (const Preset& preset : presets)
+    {
+        Board board(preset.Width, preset.Height, preset.Mines);
+        Board check(preset.Width, preset.Height, preset.Mines);
+        const int startX = preset.Width / 2, startY = preset.Height / 2;
+        size_t tested = 0, accepted = 0, found = 0;
+        double seconds = 0.0;
+        for (int i = 0; i < boards; i++)
+        {
+            const uint64_t seed = 1000 + i;
+            auto start = std::chrono::steady_clock::now();
+            NoGuessResult result = NoGuessGenerator::Generate(board, seed, startX, startY, maxCandidates, &pool);
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            tested += result.Tested;
+            accepted += result.Accepted;
+            if (!result.Found)
+                continue;
+            found++;
+
+            NoGuessResult serial = NoGuessGenerator::Generate(check, seed, startX, startY, maxCandidates);
+            bool ok = serial.Found && serial.Candidate == result.Candidate && board.GetSeed() == check.GetSeed()
+                && !board.IsMine(startX, startY) && NoGuessGenerator::IsSolvable(board, startX, startY);
+            if (!ok)
+            {
+                std::cout << preset.Name << " seed " << seed << ": BOARD DIFFERS OR NEEDS A GUESS" << std::endl;
+                consistent = false;
+            }
+        }
+
+        std::cout << std::setw(12) << preset.Name << " " << preset.Width << "x" << preset.Height << ", "
+                  << board.GetMineCount() << " mines: " << found << "/" << boards << " found, "
+                  << (tested ? 100.0 * accepted / tested : 0.0) << "% of " << tested << " candidates accepted, "
+                  << seconds * 1e3 / boards << " ms per board" << std::endl;
+    }
+    return consistent ? 0 : 1;
+}
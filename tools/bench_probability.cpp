@@ -0,0 +1,162 @@
+// Mine probability engine benchmark.
+//
+//   bench_probability [--moves N] [--check K] [width height [mines]]
+//
+// Plays a board (default 300 x 300 at expert density, 99 mines per 480
+// cells) from the opening nearest the middle, each move revealing the
+// hidden cell the engine rates least likely to be a mine, for up to N moves
+// (default 300) or until the game ends. Times the engine's Update after every
+// move, which recounts only the components the move touched, and every K
+// moves (default 10) a fresh engine counting every component, whose
+// probabilities must match. Reports milliseconds per update, components and
+// frontier cells, and how many components each update had to recount.
+//
+// Boards 63 and 127 cells wide, whose last word reads run right up to the
+// end of the row padding, are played out first, checked after every move.
+
+#include "../Board.h"
+#include "../ProbabilityEngine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    struct Game
+    {
+        int Moves;
+        int Checks;
+        size_t Guesses;
+        size_t Components;
+        size_t Recounted;
+        size_t Frontier;
+        double UpdateSeconds;
+        double FreshSeconds;
+        double Worst;
+    };
+
+    Game Play(Board& board, int moves, int check)
+    {
+        const int width = board.GetWidth(), height = board.GetHeight();
+        Game game = {};
+        board.Generate(1000);
+        // the first click opens up: the cell without adjacent mines nearest the middle
+        int x = width / 2, y = height / 2;
+        long long nearest = -1;
+        for (int cy = 0; cy < height; cy++)
+        {
+            for (int cx = 0; cx < width; cx++)
+            {
+                long long distance = (long long)(cx - width / 2) * (cx - width / 2) + (long long)(cy - height / 2) * (cy - height / 2);
+                if (!board.IsMine(cx, cy) && board.GetNeighborCount(cx, cy) == 0 && (nearest < 0 || distance < nearest))
+                {
+                    nearest = distance;
+                    x = cx;
+                    y = cy;
+                }
+            }
+        }
+        int freeX, freeY;
+        if (board.IsMine(x, y) && board.FindFreeCell(freeX, freeY))
+            board.MoveMine(x, y, freeX, freeY);
+        board.Reveal(x, y);
+
+        ProbabilityEngine engine(board);
+        for (; game.Moves < moves && !board.IsExploded() && !board.IsCleared(); game.Moves++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            engine.Update();
+            game.UpdateSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            game.Components += engine.GetComponentCount();
+            game.Recounted += engine.GetRecountedCount();
+            game.Frontier += engine.GetFrontierCellCount();
+
+            if (game.Moves % check == 0)
+            {
+                ProbabilityEngine fresh(board);
+                start = std::chrono::steady_clock::now();
+                fresh.Update();
+                game.FreshSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                game.Checks++;
+                for (int cy = 0; cy < height; cy++)
+                    for (int cx = 0; cx < width; cx++)
+                        game.Worst = std::max(game.Worst, (double)std::fabs(engine.GetProbability(cx, cy) - fresh.GetProbability(cx, cy)));
+            }
+
+            // the safest hidden cell, flags included since the engine ignores them
+            float best = 2.0f;
+            for (int cy = 0; cy < height; cy++)
+            {
+                for (int cx = 0; cx < width; cx++)
+                {
+                    CellState state = board.GetState(cx, cy);
+                    if ((state == CellState::HIDDEN || state == CellState::FLAGGED) && engine.GetProbability(cx, cy) < best)
+                    {
+                        best = engine.GetProbability(cx, cy);
+                        x = cx;
+                        y = cy;
+                    }
+                }
+            }
+            game.Guesses += best > 0.0f;
+            if (board.GetState(x, y) == CellState::FLAGGED)
+                board.ToggleFlag(x, y);
+            board.Reveal(x, y);
+        }
+        return game;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int moves = 300;
+    int check = 10;
+    int arg = 1;
+    for (; arg + 1 < argc && argv[arg][0] == '-' && argv[arg][1] == '-'; arg += 2)
+    {
+        if (std::strcmp(argv[arg], "--moves") == 0)
+            moves = std::atoi(argv[arg + 1]);
+        else if (std::strcmp(argv[arg], "--check") == 0)
+            check = std::atoi(argv[arg + 1]);
+        else
+            break;
+    }
+    int width = argc > arg + 1 ? std::atoi(argv[arg]) : 300;
+    int height = argc > arg + 1 ? std::atoi(argv[arg + 1]) : 300;
+    long long mines = argc > arg + 2 ? std::atoll(argv[arg + 2]) : (long long)width * height * 99 / 480;
+    if (width <= 0 || height <= 0 || mines < 0 || moves <= 0 || check <= 0)
+    {
+        std::cout << "usage: bench_probability [--moves N] [--check K] [width height [mines]]" << std::endl;
+        return 1;
+    }
+    std::cout << std::fixed << std::setprecision(3);
+
+    double worst = 0.0;
+    const int edgeSizes[][3] = { { 63, 3, 20 }, { 63, 16, 120 }, { 127, 5, 60 } };
+    for (const int* size : edgeSizes)
+    {
+        Board edge(size[0], size[1], size[2]);
+        Game game = Play(edge, size[0] * size[1], 1);
+        std::cout << size[0] << "x" << size[1] << ", " << size[2] << " mines: " << game.Moves << " moves, largest difference "
+                  << game.Worst << std::endl;
+        worst = std::max(worst, game.Worst);
+    }
+
+    Board board(width, height, (int)std::min<long long>(mines, (long long)width * height - 1));
+    std::cout << width << "x" << height << ", " << board.GetMineCount() << " mines" << std::endl;
+    Game game = Play(board, moves, check);
+    worst = std::max(worst, game.Worst);
+
+    std::cout << game.Moves << " moves (" << game.Guesses << " guesses), "
+              << (board.IsExploded() ? "lost" : board.IsCleared() ? "won" : "unfinished") << std::endl;
+    std::cout << "update: " << game.UpdateSeconds * 1e3 / game.Moves << " ms, " << (double)game.Components / game.Moves
+              << " components, " << (double)game.Frontier / game.Moves << " frontier cells, "
+              << (double)game.Recounted / game.Moves << " recounted" << std::endl;
+    std::cout << "fresh:  " << game.FreshSeconds * 1e3 / game.Checks << " ms, largest difference " << game.Worst << std::endl;
+    return worst < 1e-4 ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+// Flood reveal benchmark: the queue BFS main.cpp used for the first click
+// against Board::Reveal (RevealEngine's scanline fill, and its parallel
+// frontier flood for large openings).
+//
+//   bench_reveal [--iterations N] [--threads T] [width height [mines]]
+//
+// Generates a board (default 10000 x 10000 with 0.5% mines, which opens
+// almost all of it from one click), picks the zero cell nearest the center
+// and reveals from it with the BFS, the serial fill and, with a pool of T
+// threads (default: one per hardware thread, at least 2), the parallel
+// flood. Reports cells revealed, milliseconds, queue pushes for the BFS and
+// dirty chunks for the others, and checks that all reveal the same cells.
+
+#include "../Board.h"
+#include "../ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+enum LegacyState { HIDDEN, REVEALED, MEME, FLAGGED };
+
+struct LegacyCell
+{
+    LegacyState state = HIDDEN;
+    bool isMeme = false;
+    int neighboringMemeCount = 0;
+};
+
+// the first-click flood from main.cpp, over a width x height array
+size_t LegacyReveal(std::vector<LegacyCell>& grid, int width, int height, int startX, int startY, size_t& pushes)
+{
+    size_t revealed = 0;
+    std::queue<std::pair<int, int>> toReveal;
+    toReveal.push({ startX, startY });
+    pushes = 1;
+
+    while (!toReveal.empty())
+    {
+        auto [x, y] = toReveal.front();
+        toReveal.pop();
+
+        if (x < 0 || x >= width || y < 0 || y >= height)
+            continue;
+        LegacyCell& cell = grid[(size_t)y * width + x];
+        if (cell.state == REVEALED || cell.isMeme)
+            continue;
+
+        cell.state = REVEALED;
+        revealed++;
+        if (cell.neighboringMemeCount == 0)
+        {
+            for (int offsetY = -1; offsetY <= 1; ++offsetY)
+            {
+                for (int offsetX = -1; offsetX <= 1; ++offsetX)
+                {
+                    if (offsetX == 0 && offsetY == 0)
+                        continue;
+                    toReveal.push({ x + offsetX, y + offsetY });
+                    pushes++;
+                }
+            }
+        }
+    }
+    return revealed;
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 5;
+    unsigned int threads = std::max(2u, std::thread::hardware_concurrency());
+    int arg = 1;
+    for (; arg + 1 < argc && argv[arg][0] == '-' && argv[arg][1] == '-'; arg += 2)
+    {
+        if (std::strcmp(argv[arg], "--iterations") == 0)
+            iterations = std::atoi(argv[arg + 1]);
+        else if (std::strcmp(argv[arg], "--threads") == 0)
+            threads = (unsigned int)std::max(2, std::atoi(argv[arg + 1]));
+        else
+            break;
+    }
+    int width = argc > arg + 1 ? std::atoi(argv[arg]) : 10000;
+    int height = argc > arg + 1 ? std::atoi(argv[arg + 1]) : 10000;
+    long long mines = argc > arg + 2 ? std::atoll(argv[arg + 2]) : (long long)width * height / 200;
+    if (width <= 0 || height <= 0 || mines < 0 || iterations <= 0)
+    {
+        std::cout << "usage: bench_reveal [--iterations N] [--threads T] [width height [mines]]" << std::endl;
+        return 1;
+    }
+
+    const uint64_t seed = 2024;
+    Board board(width, height, (int)std::min<long long>(mines, (long long)width * height));
+    board.Generate(seed);
+
+    // the zero cell nearest the center, searched ring by ring
+    int startX = -1, startY = -1;
+    for (int r = 0; r < std::max(width, height) && startX < 0; r++)
+    {
+        for (int y = height / 2 - r; y <= height / 2 + r && startX < 0; y++)
+        {
+            for (int x = width / 2 - r; x <= width / 2 + r; x++)
+            {
+                if (board.Contains(x, y) && board.GetCell(x, y) == 0)
+                {
+                    startX = x;
+                    startY = y;
+                    break;
+                }
+            }
+        }
+    }
+    if (startX < 0)
+    {
+        std::cout << "no cell without adjacent mines" << std::endl;
+        return 1;
+    }
+    std::cout << width << "x" << height << ", " << board.GetMineCount() << " mines, revealing from ("
+              << startX << ", " << startY << ")" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+
+    std::vector<LegacyCell> grid((size_t)width * height);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            LegacyCell& cell = grid[(size_t)y * width + x];
+            cell.isMeme = board.IsMine(x, y);
+            cell.neighboringMemeCount = board.GetNeighborCount(x, y);
+        }
+    }
+    size_t pushes;
+    auto start = std::chrono::steady_clock::now();
+    size_t legacyRevealed = LegacyReveal(grid, width, height, startX, startY, pushes);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "      bfs: " << legacyRevealed << " cells in " << seconds * 1e3 << " ms, "
+              << legacyRevealed / seconds / 1e6 << " Mcells/s, " << (double)pushes / legacyRevealed
+              << " queue pushes per cell" << std::endl;
+
+    ThreadPool pool(threads);
+    bool same = true;
+    for (ThreadPool* flood : { (ThreadPool*)nullptr, &pool })
+    {
+        double total = 0.0;
+        size_t revealed = 0;
+        for (int i = 0; i < iterations; i++)
+        {
+            board.Generate(seed);
+            start = std::chrono::steady_clock::now();
+            revealed = board.Reveal(startX, startY, flood);
+            total += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        seconds = total / iterations;
+        std::cout << (flood ? " parallel: " : " scanline: ") << revealed << " cells in " << seconds * 1e3 << " ms, "
+                  << revealed / seconds / 1e6 << " Mcells/s, " << board.GetDirtyChunks().size() << " of "
+                  << (size_t)board.GetChunkColumns() * board.GetChunkRows() << " chunks dirty";
+        if (flood)
+            std::cout << ", " << threads << " threads";
+        std::cout << std::endl;
+
+        size_t mismatches = revealed != legacyRevealed;
+        for (int y = 0; y < height; y++)
+            for (int x = 0; x < width; x++)
+                mismatches += (grid[(size_t)y * width + x].state == REVEALED) != (board.GetState(x, y) == CellState::REVEALED);
+        std::cout << (mismatches ? "  MISMATCH: " : "  same cells revealed, ") << mismatches << " cells differ" << std::endl;
+        same = same && mismatches == 0;
+    }
+    return same ? 0 : 1;
+}
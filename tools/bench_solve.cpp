@@ -0,0 +1,138 @@
+// Constraint-propagation solver benchmark.
+//
+//   bench_solve [--iterations N] [width height [mines]]
+//
+// Plays a board (default 1000 x 1000 at expert density, 99 mines per 480
+// cells) to the end with the Solver: the first click is made safe by moving
+// its mine, the solver reveals every cell it can prove safe, and whenever it
+// is stuck an oracle guess reveals the first hidden safe cell so play goes
+// on. Reports milliseconds per game (solver and reveals), cells settled by
+// deduction, guesses needed and whether the solver ever contradicted the
+// real board.
+//
+// Then 40 expert boards (30 x 16, 99 mines) are opened and one safe cell next
+// to a revealed count is wrongly flagged before a fresh solver plays them:
+// every game must end, without an explosion.
+
+#include "../Board.h"
+#include "../Solver.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+int main(int argc, char** argv)
+{
+    int iterations = 5;
+    int arg = 1;
+    if (argc > arg + 1 && std::strcmp(argv[arg], "--iterations") == 0)
+    {
+        iterations = std::atoi(argv[arg + 1]);
+        arg += 2;
+    }
+    int width = argc > arg + 1 ? std::atoi(argv[arg]) : 1000;
+    int height = argc > arg + 1 ? std::atoi(argv[arg + 1]) : 1000;
+    long long mines = argc > arg + 2 ? std::atoll(argv[arg + 2]) : (long long)width * height * 99 / 480;
+    if (width <= 0 || height <= 0 || mines < 0 || iterations <= 0)
+    {
+        std::cout << "usage: bench_solve [--iterations N] [width height [mines]]" << std::endl;
+        return 1;
+    }
+
+    Board board(width, height, (int)std::min<long long>(mines, (long long)width * height - 1));
+    std::cout << width << "x" << height << ", " << board.GetMineCount() << " mines" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+
+    bool consistent = true;
+    for (int i = 0; i < iterations; i++)
+    {
+        const uint64_t seed = 1000 + i;
+        board.Generate(seed);
+        int startX = width / 2, startY = height / 2;
+        int freeX, freeY;
+        if (board.IsMine(startX, startY) && board.FindFreeCell(freeX, freeY))
+            board.MoveMine(startX, startY, freeX, freeY);
+
+        auto start = std::chrono::steady_clock::now();
+        Solver solver(board);
+        solver.Reveal(startX, startY);
+        size_t guesses = 0;
+        int scanX = 0, scanY = 0;
+        while (!solver.Play() && !board.IsExploded())
+        {
+            // stuck: the oracle reveals the next hidden safe cell
+            while (scanY < height && (board.IsMine(scanX, scanY) || board.GetState(scanX, scanY) != CellState::HIDDEN))
+            {
+                if (++scanX == width)
+                {
+                    scanX = 0;
+                    scanY++;
+                }
+            }
+            if (scanY == height)
+                break;
+            solver.Reveal(scanX, scanY);
+            guesses++;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        size_t wrongMines = 0;
+        for (int y = 0; y < height; y++)
+            for (int x = 0; x < width; x++)
+                wrongMines += solver.IsKnownMine(x, y) && !board.IsMine(x, y);
+        bool ok = board.IsCleared() && wrongMines == 0;
+        consistent = consistent && ok;
+        std::cout << "seed " << seed << ": " << seconds * 1e3 << " ms, " << solver.GetSafeCount() << " safe and "
+                  << solver.GetMineCount() << " mines deduced, " << guesses << " guesses"
+                  << (ok ? "" : ", SOLVER CONTRADICTS BOARD") << std::endl;
+    }
+
+    size_t flagged = 0, stopped = 0;
+    for (uint64_t seed = 1; seed <= 40; seed++)
+    {
+        Board expert(30, 16, 99);
+        expert.Generate(seed);
+        int freeX, freeY;
+        if (expert.IsMine(15, 8) && expert.FindFreeCell(freeX, freeY))
+            expert.MoveMine(15, 8, freeX, freeY);
+        expert.Reveal(15, 8);
+
+        // the first hidden safe cell next to a revealed count gets the flag
+        bool placed = false;
+        for (int y = 0; y < 16 && !placed; y++)
+        {
+            for (int x = 0; x < 30 && !placed; x++)
+            {
+                if (expert.GetState(x, y) != CellState::REVEALED || expert.GetNeighborCount(x, y) == 0)
+                    continue;
+                for (int dy = -1; dy <= 1 && !placed; dy++)
+                {
+                    for (int dx = -1; dx <= 1 && !placed; dx++)
+                    {
+                        int nx = x + dx, ny = y + dy;
+                        if (expert.Contains(nx, ny) && expert.GetState(nx, ny) == CellState::HIDDEN && !expert.IsMine(nx, ny))
+                        {
+                            expert.ToggleFlag(nx, ny);
+                            placed = true;
+                        }
+                    }
+                }
+            }
+        }
+        if (!placed)
+            continue;
+        flagged++;
+
+        Solver solver(expert);
+        stopped += !solver.Play();
+        if (expert.IsExploded())
+        {
+            std::cout << "seed " << seed << " with a wrong flag: SOLVER REVEALED A MINE" << std::endl;
+            consistent = false;
+        }
+    }
+    std::cout << flagged << " boards with a wrong flag played to an end, " << stopped << " stopped short of clearing" << std::endl;
+    return consistent ? 0 : 1;
+}
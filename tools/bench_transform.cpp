@@ -0,0 +1,93 @@
+// Batched SoA transform benchmark.
+//
+//   bench_transform [--iterations N]
+//
+// Transforms 1K, 16K and 256K random 2D positions (z = 0, w = 1, as for board
+// cells) by one mat4: per vector with glm on an AoS vec4 array, then with
+// BatchTransform at every SIMD level the CPU supports. Reports millions of
+// vectors per second and the largest difference from the glm results.
+
+#include "../BatchTransform.h"
+#include "../CpuFeatures.h"
+
+#include "../glm/gtc/matrix_transform.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    int iterations = 200;
+    if (argc > 2 && std::strcmp(argv[1], "--iterations") == 0)
+        iterations = std::atoi(argv[2]);
+
+    CpuFeatures::Get().Print();
+
+    glm::mat4 matrix = glm::ortho(-320.0f, 320.0f, -320.0f, 320.0f, -1.0f, 1.0f)
+        * glm::rotate(glm::mat4(1.0f), 0.3f, glm::vec3(0.0f, 0.0f, 1.0f))
+        * glm::translate(glm::mat4(1.0f), glm::vec3(-40.0f, 12.5f, 0.0f));
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-400.0f, 400.0f);
+    std::cout << std::fixed << std::setprecision(1);
+
+    for (size_t count : { (size_t)1 << 10, (size_t)1 << 14, (size_t)1 << 18 })
+    {
+        std::vector<glm::vec4> aos(count), aosOut(count);
+        std::vector<float> x(count), y(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            x[i] = dist(rng);
+            y[i] = dist(rng);
+            aos[i] = glm::vec4(x[i], y[i], 0.0f, 1.0f);
+        }
+        // smaller sets repeat more so every row does similar work
+        int passes = (int)std::max<size_t>(1, iterations * ((size_t)1 << 18) / count / 16);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; pass++)
+            for (size_t i = 0; i < count; i++)
+                aosOut[i] = matrix * aos[i];
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::setw(7) << count << " glm aos: " << (double)count * passes / seconds / 1e6 << " Mvec/s" << std::endl;
+
+        std::vector<float> ox(count), oy(count), oz(count), ow(count);
+        SoaInput in;
+        in.X = x.data();
+        in.Y = y.data();
+        SoaOutput out;
+        out.X = ox.data();
+        out.Y = oy.data();
+        out.Z = oz.data();
+        out.W = ow.data();
+
+        SimdLevel best = CpuFeatures::Get().GetBestLevel();
+        for (int level = 0; level <= (int)best; level++)
+        {
+            start = std::chrono::steady_clock::now();
+            for (int pass = 0; pass < passes; pass++)
+                BatchTransform::Transform((SimdLevel)level, matrix, in, out, count);
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            float diff = 0.0f;
+            for (size_t i = 0; i < count; i++)
+            {
+                diff = std::max(diff, std::fabs(ox[i] - aosOut[i].x));
+                diff = std::max(diff, std::fabs(oy[i] - aosOut[i].y));
+                diff = std::max(diff, std::fabs(oz[i] - aosOut[i].z));
+                diff = std::max(diff, std::fabs(ow[i] - aosOut[i].w));
+            }
+            std::cout << std::setw(7) << count << " " << std::setw(7) << CpuFeatures::GetLevelName((SimdLevel)level) << ": "
+                      << (double)count * passes / seconds / 1e6 << " Mvec/s, max diff " << std::scientific
+                      << std::setprecision(2) << diff << std::fixed << std::setprecision(1) << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+// Packs shaders and images into a single archive readable by AssetArchive.
+//
+//   pack_assets [--decode] <out.pak> <files...>
+//
+// Asset names are the paths exactly as given, so run it from the directory the
+// game is started from, e.g.
+//   pack_assets assets.pak basic.shader pngegg.png res/*.png
+// With --decode images are stored as flipped RGBA8 and upload without decoding.
+
+#include "../AssetArchive.h"
+#include "../MappedFile.h"
+#include "../stb_image.h"
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static bool IsImage(const std::string& path)
+{
+    static const char* extensions[] = { ".png", ".jpg", ".jpeg", ".bmp", ".tga" };
+    for (const char* extension : extensions)
+    {
+        size_t length = std::strlen(extension);
+        if (path.size() >= length && path.compare(path.size() - length, length, extension) == 0)
+            return true;
+    }
+    return false;
+}
+
+int main(int argc, char** argv)
+{
+    bool decode = false;
+    int first = 1;
+    if (argc > first && std::strcmp(argv[first], "--decode") == 0)
+    {
+        decode = true;
+        first++;
+    }
+    if (argc - first < 2)
+    {
+        std::cout << "usage: pack_assets [--decode] <out.pak> <files...>" << std::endl;
+        return 1;
+    }
+
+    AssetArchiveWriter writer;
+    for (int i = first + 1; i < argc; i++)
+    {
+        std::string path = argv[i];
+        MappedFile file(path, FileAccess::SEQUENTIAL);
+        if (!file.IsOpen())
+        {
+            std::cout << "cannot read " << path << std::endl;
+            return 1;
+        }
+
+        if (decode && IsImage(path))
+        {
+            int width = 0, height = 0, channels = 0;
+            stbi_set_flip_vertically_on_load(1);
+            unsigned char* pixels = stbi_load_from_memory(file.GetData(), (int)file.GetSize(), &width, &height, &channels, 4);
+            if (!pixels)
+            {
+                std::cout << "cannot decode " << path << ": " << stbi_failure_reason() << std::endl;
+                return 1;
+            }
+            writer.Add(path, std::vector<unsigned char>(pixels, pixels + (size_t)width * height * 4),
+                       AssetEncoding::RGBA8, (uint32_t)width, (uint32_t)height);
+            stbi_image_free(pixels);
+        }
+        else
+        {
+            writer.Add(path, std::vector<unsigned char>(file.GetData(), file.GetData() + file.GetSize()),
+                       IsImage(path) ? AssetEncoding::IMAGE : AssetEncoding::RAW);
+        }
+        std::cout << "packed " << path << std::endl;
+    }
+
+    if (!writer.Write(argv[first]))
+    {
+        std::cout << "cannot write " << argv[first] << std::endl;
+        return 1;
+    }
+    return 0;
+}